@@ -0,0 +1,68 @@
+// AStar expansion throughput with the binary heap and the bucket queue open sets
+
+#include "Benchmark.hpp"
+#include "Engine/AStar.hpp"
+
+namespace
+{
+	struct Query
+	{
+		Vec2i start;
+		Vec2i end;
+	};
+
+	std::vector<Query> makeQueries(const Benchmark::Grid& grid, int numQueries)
+	{
+		Rng rng(numQueries);
+		const auto floor = grid.getFloor();
+
+		std::vector<Query> queries;
+
+		for (int i = 0; i < numQueries; ++i)
+			queries.push_back({ rng.pickOne(floor), rng.pickOne(floor) });
+
+		return queries;
+	}
+
+	void run(std::string_view name, const Benchmark::Grid& grid, const std::vector<Query>& queries)
+	{
+		AStar aStar(grid.width, grid.height, [&] (const Vec2i& pos) { return grid.isPassable(pos); });
+
+		for (const auto openSet : { AStar::OpenSet::BinaryHeap, AStar::OpenSet::Buckets })
+		{
+			aStar.setOpenSet(openSet);
+
+			std::size_t numExpanded = 0;
+			std::size_t totalLength = 0;
+			Benchmark::Timer timer;
+
+			for (const auto& query : queries)
+			{
+				const auto path = aStar.findPath(query.start, query.end);
+				numExpanded += aStar.getNumExpanded();
+				totalLength += path.size();
+			}
+
+			const double seconds = timer.getSeconds();
+
+			std::string label(name);
+			label += openSet == AStar::OpenSet::Buckets ? " (buckets)" : " (binary heap)";
+
+			Benchmark::report(label, seconds, numExpanded, "node");
+			std::cout << "    " << queries.size() << " paths, " << totalLength << " cells in total\n";
+		}
+	}
+}
+
+int main()
+{
+	const auto smallDungeon = Benchmark::makeDungeon(80, 25, 2020);
+	const auto largeDungeon = Benchmark::makeDungeon(400, 200, 2020);
+	const auto openMap = Benchmark::makeOpenMap(512, 512, 2020);
+
+	run("Dungeon 80x25", smallDungeon, makeQueries(smallDungeon, 5000));
+	run("Dungeon 400x200", largeDungeon, makeQueries(largeDungeon, 200));
+	run("Open map 512x512", openMap, makeQueries(openMap, 100));
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+// Shared helpers for the native benchmarks. These only depend on the Engine
+// classes that do not need SDL, so they can run on machines without a display.
+
+#pragma once
+
+#include "Engine/Vector2.hpp"
+#include "Engine/Rng.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Benchmark
+{
+	// Character grid laid out like the Part13 Map ('#' wall, '.' floor, '+' door)
+	struct Grid
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<char> cells;
+
+		char at(const Vec2i& position) const
+		{
+			return cells[position.x + position.y * width];
+		}
+
+		bool isPassable(const Vec2i& position) const
+		{
+			const char ch = at(position);
+			return ch == '.' || ch == '+';
+		}
+
+		bool blocksView(const Vec2i& position) const
+		{
+			const char ch = at(position);
+			return ch != '.';
+		}
+
+		std::vector<Vec2i> getFloor() const
+		{
+			std::vector<Vec2i> floor;
+
+			for (int y = 0; y < height; ++y)
+				for (int x = 0; x < width; ++x)
+					if (at({ x, y }) == '.')
+						floor.emplace_back(x, y);
+
+			return floor;
+		}
+	};
+
+	// Same room-and-door algorithm as generateDungeon() in Part13/Map.cpp
+	inline Grid makeDungeon(int width, int height, unsigned int seed)
+	{
+		Grid grid{ width, height, std::vector<char>(width * height, ' ') };
+		Rng rng(seed);
+
+		const auto at = [&] (int x, int y) -> char& { return grid.cells[x + y * width]; };
+
+		const auto addRoom = [&] (int start)
+		{
+			const int w = rng.getInt(5, 14);
+			const int h = rng.getInt(3, 8);
+
+			const int left   = rng.getInt(width - w - 2);
+			const int top    = rng.getInt(height - h - 2);
+			const int right  = left + w + 2;
+			const int bottom = top + h + 2;
+
+			for (int y = top; y <= bottom; ++y)
+				for (int x = left; x <= right; ++x)
+					if (at(x, y) == '.')
+						return;
+
+			int doorCount = 0;
+			int dx = 0, dy = 0;
+
+			if (!start)
+			{
+				for (int y = top; y <= bottom; ++y)
+					for (int x = left; x <= right; ++x)
+					{
+						const int s = x == left || x == right;
+						const int t = y == top || y == bottom;
+						if (s ^ t && at(x, y) == '#')
+						{
+							if (rng.getInt(++doorCount) == 0)
+							{
+								dx = x;
+								dy = y;
+							}
+						}
+					}
+
+				if (doorCount == 0)
+					return;
+			}
+
+			for (int y = top; y <= bottom; ++y)
+				for (int x = left; x <= right; ++x)
+				{
+					const int s = x == left || x == right;
+					const int t = y == top || y == bottom;
+					at(x, y) = s && t ? '!' : s ^ t ? '#' : '.';
+				}
+
+			if (doorCount > 0)
+				at(dx, dy) = '+';
+		};
+
+		for (int i = 0; i < width * height; ++i)
+			addRoom(i == 0);
+
+		for (auto& ch : grid.cells)
+			if (ch == '!' || ch == ' ')
+				ch = '#';
+
+		return grid;
+	}
+
+	// Open floor surrounded by walls with a sprinkle of pillars
+	inline Grid makeOpenMap(int width, int height, unsigned int seed)
+	{
+		Grid grid{ width, height, std::vector<char>(width * height, '.') };
+		Rng rng(seed);
+
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+			{
+				char& ch = grid.cells[x + y * width];
+
+				if (x == 0 || y == 0 || x == width - 1 || y == height - 1 || rng.getInt(20) == 0)
+					ch = '#';
+			}
+
+		return grid;
+	}
+
+	class Timer
+	{
+	public:
+		Timer()
+			: m_start(std::chrono::steady_clock::now())
+		{
+		}
+
+		double getSeconds() const
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// Keeps the optimizer from throwing away benchmarked work
+	inline const volatile void* Sink = nullptr;
+
+	template <typename T>
+	void doNotOptimize(const T& value)
+	{
+		Sink = &value;
+	}
+
+	inline void report(std::string_view name, double seconds, std::size_t iterations, std::string_view unit = "op")
+	{
+		std::cout << std::left << std::setw(48) << name << std::right
+			<< std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1e6 / iterations << " us/" << unit
+			<< std::setw(14) << std::setprecision(0) << iterations / seconds << ' ' << unit << "/s\n";
+	}
+}
@@ -0,0 +1,50 @@
+// Shadowcasting cost per Fov::compute at the Part13 range and at larger radii
+
+#include "Benchmark.hpp"
+#include "Engine/Fov.hpp"
+
+#include <string>
+
+namespace
+{
+	void run(const std::string& name, const Benchmark::Grid& grid, int range, int numQueries)
+	{
+		const auto blocksView = [&] (const Vec2i& pos) { return grid.blocksView(pos); };
+		BasicFov<decltype(blocksView)> fov(grid.width, grid.height, blocksView);
+
+		Rng rng(numQueries);
+		const auto floor = grid.getFloor();
+		std::vector<Vec2i> points;
+
+		for (int i = 0; i < numQueries; ++i)
+			points.push_back(rng.pickOne(floor));
+
+		Benchmark::Timer timer;
+
+		for (const Vec2i& point : points)
+		{
+			fov.clear();
+			fov.compute(point, range);
+		}
+
+		Benchmark::report(name + ", range " + std::to_string(range), timer.getSeconds(), points.size(), "query");
+	}
+}
+
+int main()
+{
+	const auto dungeon = Benchmark::makeDungeon(80, 25, 2020);
+	const auto largeDungeon = Benchmark::makeDungeon(400, 200, 2020);
+	const auto openMap = Benchmark::makeOpenMap(400, 200, 2020);
+
+	// Part13 uses a range of 10
+	run("Part13 dungeon", dungeon, 10, 50000);
+
+	for (const int range : { 10, 20, 40, 80 })
+	{
+		run("Large dungeon", largeDungeon, range, 20000);
+		run("Open map", openMap, range, 5000);
+	}
+
+	return 0;
+}
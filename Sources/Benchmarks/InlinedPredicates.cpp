@@ -0,0 +1,92 @@
+// Per-query cost of AStar/Fov (std::function predicates) versus
+// BasicAStar/BasicFov instantiated with inlinable lambdas, on Part13 sized maps
+
+#include "Benchmark.hpp"
+#include "Engine/AStar.hpp"
+#include "Engine/Fov.hpp"
+
+#include <cstdint>
+
+namespace
+{
+	constexpr int MapWidth = 80;
+	constexpr int MapHeight = 25;
+	constexpr int FovRange = 10;
+	constexpr int NumQueries = 20000;
+
+	template <typename AStarType>
+	double runAStar(AStarType& aStar, const std::vector<Vec2i>& points)
+	{
+		aStar.setMaxCost(25);
+
+		Benchmark::Timer timer;
+
+		for (std::size_t i = 0; i + 1 < points.size(); ++i)
+		{
+			const auto path = aStar.findPath(points[i], points[i + 1]);
+			Benchmark::doNotOptimize(path);
+		}
+
+		return timer.getSeconds();
+	}
+
+	template <typename FovType>
+	double runFov(FovType& fov, const std::vector<Vec2i>& points)
+	{
+		Benchmark::Timer timer;
+
+		for (const Vec2i& point : points)
+		{
+			fov.clear();
+			fov.compute(point, FovRange);
+		}
+
+		return timer.getSeconds();
+	}
+}
+
+int main()
+{
+	const auto grid = Benchmark::makeDungeon(MapWidth, MapHeight, 2020);
+
+	// One byte per cell, the kind of raw grid a map can hand out
+	std::vector<std::uint8_t> passable(grid.cells.size());
+	std::vector<std::uint8_t> opaque(grid.cells.size());
+
+	for (std::size_t i = 0; i < grid.cells.size(); ++i)
+	{
+		passable[i] = grid.cells[i] == '.' || grid.cells[i] == '+';
+		opaque[i] = grid.cells[i] != '.';
+	}
+
+	Rng rng(NumQueries);
+	const auto floor = grid.getFloor();
+	std::vector<Vec2i> points;
+
+	for (int i = 0; i < NumQueries; ++i)
+		points.push_back(rng.pickOne(floor));
+
+	// AStar
+	{
+		AStar erased(MapWidth, MapHeight, [&] (const Vec2i& pos) { return grid.isPassable(pos); });
+
+		const auto isPassable = [&] (const Vec2i& pos) { return passable[pos.x + pos.y * MapWidth] != 0; };
+		BasicAStar<decltype(isPassable)> inlined(MapWidth, MapHeight, isPassable);
+
+		Benchmark::report("AStar (std::function)", runAStar(erased, points), points.size() - 1, "query");
+		Benchmark::report("BasicAStar (lambda, raw grid)", runAStar(inlined, points), points.size() - 1, "query");
+	}
+
+	// Fov
+	{
+		Fov erased(MapWidth, MapHeight, [&] (const Vec2i& pos) { return grid.blocksView(pos); });
+
+		const auto blocksView = [&] (const Vec2i& pos) { return opaque[pos.x + pos.y * MapWidth] != 0; };
+		BasicFov<decltype(blocksView)> inlined(MapWidth, MapHeight, blocksView);
+
+		Benchmark::report("Fov (std::function)", runFov(erased, points), points.size(), "query");
+		Benchmark::report("BasicFov (lambda, raw grid)", runFov(inlined, points), points.size(), "query");
+	}
+
+	return 0;
+}
@@ -0,0 +1,96 @@
+// Hundreds of monsters computing their own field of view on one level:
+// one BasicFov per monster versus FovBatch on one thread and on every core
+
+#include "Benchmark.hpp"
+#include "Engine/FovBatch.hpp"
+
+#include <string>
+
+namespace
+{
+	constexpr int NumTurns = 200;
+
+	double runSingle(const BitGrid& opaque, const std::vector<FovBatch::Viewer>& viewers, std::size_t& numVisible)
+	{
+		BasicFov<BitGrid::Reader> fov(opaque.getWidth(), opaque.getHeight(), { &opaque });
+
+		Benchmark::Timer timer;
+
+		for (int turn = 0; turn < NumTurns; ++turn)
+		{
+			for (const auto& viewer : viewers)
+			{
+				fov.clear();
+				fov.compute(viewer.position, viewer.range);
+			}
+		}
+
+		const double seconds = timer.getSeconds();
+
+		numVisible = 0;
+		fov.forEachVisible([&] (const Vec2i&) { ++numVisible; });
+
+		return seconds;
+	}
+
+	double runBatch(FovBatch& batch, const BitGrid& opaque, const std::vector<FovBatch::Viewer>& viewers, std::size_t& numVisible)
+	{
+		Benchmark::Timer timer;
+
+		for (int turn = 0; turn < NumTurns; ++turn)
+			batch.compute(opaque, viewers);
+
+		const double seconds = timer.getSeconds();
+
+		numVisible = batch.getNumVisible(viewers.size() - 1);
+
+		return seconds;
+	}
+
+	void run(const std::string& name, const Benchmark::Grid& grid, int numViewers)
+	{
+		BitGrid opaque(grid.width, grid.height);
+
+		for (int y = 0; y < grid.height; ++y)
+			for (int x = 0; x < grid.width; ++x)
+				opaque.set(x, y, grid.blocksView({ x, y }));
+
+		// Part13 orcs and trolls see 8 and 6 cells away
+		Rng rng(numViewers);
+		const auto floor = grid.getFloor();
+		std::vector<FovBatch::Viewer> viewers;
+
+		for (int i = 0; i < numViewers; ++i)
+			viewers.push_back({ rng.pickOne(floor), rng.getInt(1) ? 8 : 6 });
+
+		const std::size_t numFovs = viewers.size() * NumTurns;
+		std::size_t single = 0;
+		std::size_t serial = 0;
+		std::size_t parallel = 0;
+
+		FovBatch serialBatch(1);
+		FovBatch parallelBatch;
+
+		const std::string label = name + ", " + std::to_string(numViewers) + " viewers";
+
+		Benchmark::report(label + " (BasicFov)", runSingle(opaque, viewers, single), numFovs, "fov");
+		Benchmark::report(label + " (FovBatch, 1 thread)", runBatch(serialBatch, opaque, viewers, serial), numFovs, "fov");
+		Benchmark::report(label + " (FovBatch, " + std::to_string(parallelBatch.getNumThreads()) + " threads)",
+			runBatch(parallelBatch, opaque, viewers, parallel), numFovs, "fov");
+
+		// The last viewer must see the same cells every way
+		if (single != serial || single != parallel)
+			std::cout << "    mismatch: " << single << ' ' << serial << ' ' << parallel << '\n';
+	}
+}
+
+int main()
+{
+	const auto dungeon = Benchmark::makeDungeon(80, 25, 2020);
+	const auto largeDungeon = Benchmark::makeDungeon(400, 200, 2020);
+
+	run("Part13 dungeon", dungeon, 200);
+	run("Large dungeon", largeDungeon, 500);
+
+	return 0;
+}
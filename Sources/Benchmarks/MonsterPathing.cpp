@@ -0,0 +1,91 @@
+// Enemy turn cost: one AStar::findPath per chasing monster versus
+// a single DijkstraMap shared by all of them.
+
+#include "Benchmark.hpp"
+#include "Engine/AStar.hpp"
+#include "Engine/DijkstraMap.hpp"
+
+namespace
+{
+	constexpr int MapWidth = 80;
+	constexpr int MapHeight = 25;
+	constexpr int NumTurns = 200;
+	constexpr std::size_t MaxCost = 25;
+
+	struct Scenario
+	{
+		std::vector<Vec2i> players; // Player position for each turn
+		std::vector<Vec2i> monsters;
+	};
+
+	Scenario makeScenario(const Benchmark::Grid& grid, int numMonsters)
+	{
+		Rng rng(numMonsters);
+		const auto floor = grid.getFloor();
+
+		Scenario scenario;
+
+		for (int i = 0; i < NumTurns; ++i)
+			scenario.players.push_back(rng.pickOne(floor));
+
+		for (int i = 0; i < numMonsters; ++i)
+			scenario.monsters.push_back(rng.pickOne(floor));
+
+		return scenario;
+	}
+
+	double runAStar(const Benchmark::Grid& grid, const Scenario& scenario)
+	{
+		AStar aStar(grid.width, grid.height, [&] (const Vec2i& pos) { return grid.isPassable(pos); });
+		aStar.setMaxCost(MaxCost);
+
+		Benchmark::Timer timer;
+
+		for (const Vec2i& player : scenario.players)
+			for (const Vec2i& monster : scenario.monsters)
+			{
+				const auto path = aStar.findPath(player, monster);
+				Benchmark::doNotOptimize(path);
+			}
+
+		return timer.getSeconds();
+	}
+
+	double runDijkstraMap(const Benchmark::Grid& grid, const Scenario& scenario)
+	{
+		DijkstraMap flowField(grid.width, grid.height, [&] (const Vec2i& pos) { return grid.isPassable(pos); });
+		flowField.setMaxCost(MaxCost);
+
+		Benchmark::Timer timer;
+
+		for (const Vec2i& player : scenario.players)
+		{
+			// The player moves every turn, so this is the worst case
+			flowField.compute(player);
+
+			for (const Vec2i& monster : scenario.monsters)
+			{
+				const Vec2i next = flowField.getNextStep(monster);
+				Benchmark::doNotOptimize(next);
+			}
+		}
+
+		return timer.getSeconds();
+	}
+}
+
+int main()
+{
+	const auto grid = Benchmark::makeDungeon(MapWidth, MapHeight, 2020);
+
+	for (const int numMonsters : { 10, 100, 1000 })
+	{
+		const auto scenario = makeScenario(grid, numMonsters);
+		const std::string suffix = " (" + std::to_string(numMonsters) + " monsters)";
+
+		Benchmark::report("AStar per monster" + suffix, runAStar(grid, scenario), NumTurns, "turn");
+		Benchmark::report("DijkstraMap per turn" + suffix, runDijkstraMap(grid, scenario), NumTurns, "turn");
+	}
+
+	return 0;
+}
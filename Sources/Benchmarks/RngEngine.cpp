@@ -0,0 +1,233 @@
+// Rng (PCG32, Lemire bounded integers) versus std::mt19937 with std::uniform_int_distribution:
+// seeding, raw and bounded throughput, then a few statistical sanity checks
+
+#include "Benchmark.hpp"
+
+#include <algorithm> // shuffle, max
+#include <array>
+#include <cmath> // sqrt, abs
+#include <cstdint>
+#include <numeric> // iota
+#include <random>
+
+namespace
+{
+	constexpr int NumDraws = 20'000'000;
+	constexpr int NumSeeds = 200'000;
+
+	// Pearson correlation of two sequences of 32-bit draws
+	template <typename DrawA, typename DrawB>
+	double getCorrelation(DrawA drawA, DrawB drawB, int count)
+	{
+		double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			const double a = drawA() / 4294967296.0;
+			const double b = drawB() / 4294967296.0;
+
+			sumA += a;
+			sumB += b;
+			sumAA += a * a;
+			sumBB += b * b;
+			sumAB += a * b;
+		}
+
+		const double covariance = sumAB / count - sumA / count * sumB / count;
+		const double varianceA = sumAA / count - sumA / count * sumA / count;
+		const double varianceB = sumBB / count - sumB / count * sumB / count;
+
+		return covariance / std::sqrt(varianceA * varianceB);
+	}
+
+	void runThroughput()
+	{
+		std::cout << "Throughput\n";
+
+		{
+			Benchmark::Timer timer;
+			std::uint32_t sum = 0;
+
+			for (int i = 0; i < NumSeeds; ++i)
+				sum += std::mt19937(i)();
+
+			Benchmark::report("std::mt19937 seed + draw", timer.getSeconds(), NumSeeds, "seed");
+			Benchmark::doNotOptimize(sum);
+		}
+
+		{
+			Benchmark::Timer timer;
+			std::uint32_t sum = 0;
+
+			for (int i = 0; i < NumSeeds; ++i)
+				sum += Rng(i).next();
+
+			Benchmark::report("Rng seed + draw", timer.getSeconds(), NumSeeds, "seed");
+			Benchmark::doNotOptimize(sum);
+		}
+
+		{
+			std::mt19937 engine(2020);
+			Benchmark::Timer timer;
+			std::uint32_t sum = 0;
+
+			for (int i = 0; i < NumDraws; ++i)
+				sum += engine();
+
+			Benchmark::report("std::mt19937 32 bits", timer.getSeconds(), NumDraws, "draw");
+			Benchmark::doNotOptimize(sum);
+		}
+
+		{
+			Rng rng(2020);
+			Benchmark::Timer timer;
+			std::uint32_t sum = 0;
+
+			for (int i = 0; i < NumDraws; ++i)
+				sum += rng.next();
+
+			Benchmark::report("Rng::next", timer.getSeconds(), NumDraws, "draw");
+			Benchmark::doNotOptimize(sum);
+		}
+
+		// Small ranges like the dungeon generator and the AI use
+		{
+			std::mt19937 engine(2020);
+			Benchmark::Timer timer;
+			int sum = 0;
+
+			for (int i = 0; i < NumDraws; ++i)
+				sum += std::uniform_int_distribution<>(-1, 1 + (i & 7))(engine);
+
+			Benchmark::report("uniform_int_distribution [-1, 1..8]", timer.getSeconds(), NumDraws, "draw");
+			Benchmark::doNotOptimize(sum);
+		}
+
+		{
+			Rng rng(2020);
+			Benchmark::Timer timer;
+			int sum = 0;
+
+			for (int i = 0; i < NumDraws; ++i)
+				sum += rng.getInt(-1, 1 + (i & 7));
+
+			Benchmark::report("Rng::getInt [-1, 1..8]", timer.getSeconds(), NumDraws, "draw");
+			Benchmark::doNotOptimize(sum);
+		}
+
+		{
+			std::vector<int> values(100);
+			std::iota(values.begin(), values.end(), 0);
+			std::mt19937 engine(2020);
+			Benchmark::Timer timer;
+
+			for (int i = 0; i < NumDraws / 100; ++i)
+				std::shuffle(values.begin(), values.end(), engine);
+
+			Benchmark::report("std::shuffle 100 values", timer.getSeconds(), NumDraws / 100, "shuffle");
+			Benchmark::doNotOptimize(values);
+		}
+
+		{
+			std::vector<int> values(100);
+			std::iota(values.begin(), values.end(), 0);
+			Rng rng(2020);
+			Benchmark::Timer timer;
+
+			for (int i = 0; i < NumDraws / 100; ++i)
+				rng.shuffle(values);
+
+			Benchmark::report("Rng::shuffle 100 values", timer.getSeconds(), NumDraws / 100, "shuffle");
+			Benchmark::doNotOptimize(values);
+		}
+	}
+
+	void runQuality()
+	{
+		std::cout << "Quality\n";
+		std::cout << std::fixed << std::setprecision(4);
+
+		// Chi-squared of a die, 5 degrees of freedom: above 11.07 happens 5% of the time
+		{
+			Rng rng(2020);
+			std::array<int, 6> counts = {};
+
+			for (int i = 0; i < NumDraws; ++i)
+				++counts[rng.getInt(6)];
+
+			double chiSquared = 0.0;
+			const double expected = NumDraws / 6.0;
+
+			for (const int count : counts)
+				chiSquared += (count - expected) * (count - expected) / expected;
+
+			std::cout << "  getInt(6) chi-squared: " << chiSquared << " (5% critical value 11.07)\n";
+		}
+
+		// Modulo favors the low values of a bound that does not divide 2^32
+		{
+			constexpr std::uint32_t bound = 3u << 30;
+			Rng rng(2020);
+			int lemireLow = 0;
+			int moduloLow = 0;
+
+			for (int i = 0; i < NumDraws; ++i)
+			{
+				lemireLow += rng.getBounded(bound) < (1u << 31);
+				moduloLow += rng.next() % bound < (1u << 31);
+			}
+
+			std::cout << "  below 2/3 of a 3 * 2^30 bound: " << static_cast<double>(lemireLow) / NumDraws
+				<< " bounded, " << static_cast<double>(moduloLow) / NumDraws << " modulo (expected 0.6667)\n";
+		}
+
+		// Every output bit should be set half of the time
+		{
+			Rng rng(2020);
+			std::array<int, 32> ones = {};
+
+			for (int i = 0; i < NumDraws; ++i)
+			{
+				const std::uint32_t value = rng.next();
+
+				for (int bit = 0; bit < 32; ++bit)
+					ones[bit] += (value >> bit) & 1;
+			}
+
+			double worst = 0.0;
+
+			for (const int count : ones)
+				worst = std::max(worst, std::abs(static_cast<double>(count) / NumDraws - 0.5));
+
+			std::cout << "  worst bit bias: " << worst << " (expected about " << 0.5 / std::sqrt(NumDraws) * 3 << " or less)\n";
+		}
+
+		// Consecutive draws, neighbouring seeds and the streams of one seed should not correlate
+		{
+			Rng rng(2020);
+			Rng seedA(2020);
+			Rng seedB(2021);
+			Rng streamA(2020, 0);
+			Rng streamB(2020, 1);
+
+			std::cout << "  correlation of consecutive draws: " << getCorrelation([&] { return rng.next(); }, [&] { return rng.next(); }, NumDraws / 2) << '\n';
+			std::cout << "  correlation of seeds 2020 and 2021: " << getCorrelation([&] { return seedA.next(); }, [&] { return seedB.next(); }, NumDraws / 2) << '\n';
+			std::cout << "  correlation of streams 0 and 1: " << getCorrelation([&] { return streamA.next(); }, [&] { return streamB.next(); }, NumDraws / 2) << '\n';
+			std::cout << "    (expected about " << 1.0 / std::sqrt(NumDraws / 2) << " or less)\n";
+		}
+
+		// The same seed gives the same numbers everywhere, see the PCG32 reference output
+		{
+			Rng rng(42, 54);
+			std::cout << "  first draw of seed 42 stream 54: 0x" << std::hex << rng.next() << std::dec << " (expected 0xa15c02b7)\n";
+		}
+	}
+}
+
+int main()
+{
+	runThroughput();
+	runQuality();
+
+	return 0;
+}
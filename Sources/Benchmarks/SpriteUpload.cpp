@@ -0,0 +1,116 @@
+// Bytes the renderer sends to the GPU per frame for an 80x30 console:
+// float vertices and indices re-uploaded every frame, instanced records,
+// and the packed vertices of SpriteBatch where only changed ranges are uploaded
+
+#include "Benchmark.hpp"
+#include "Engine/SpriteBatch.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+	constexpr int Width = 80;
+	constexpr int Height = 30;
+	constexpr int TileWidth = 12;
+	constexpr int TileHeight = 24;
+	constexpr int NumFrames = 2000;
+
+	// Same sizes as the Attributes + GLuint indices of the old path and the Instance of the instanced one
+	constexpr std::size_t FloatSpriteBytes = 4 * 40 + 6 * 4;
+	constexpr std::size_t InstanceBytes = 20;
+
+	// Glyph tiles of a 16x16 atlas, the last one is the solid background tile
+	std::vector<SpriteLocation> makeLocations()
+	{
+		std::vector<SpriteLocation> locations;
+
+		for (int i = 0; i < 256; ++i)
+		{
+			const float s = (i % 16) / 16.f;
+			const float t = (i / 16) / 16.f;
+
+			locations.push_back({ 0.f, 0.f, TileWidth, TileHeight, s, t, s + 1 / 16.f, t + 1 / 16.f });
+		}
+
+		return locations;
+	}
+
+	// Laid out like Console: background rectangle, then background and glyph of every cell
+	std::vector<Sprite> makeSprites(Rng& rng)
+	{
+		std::vector<Sprite> sprites(Width * Height * 2 + 1);
+
+		sprites[0].id = 255;
+		sprites[0].scaleX = Width;
+		sprites[0].scaleY = Height;
+
+		for (int i = 0; i < Width * Height; ++i)
+		{
+			Sprite& bg = sprites[1 + i * 2];
+			Sprite& glyph = sprites[2 + i * 2];
+
+			bg.id = 255;
+			bg.x = glyph.x = static_cast<float>(i % Width * TileWidth);
+			bg.y = glyph.y = static_cast<float>(i / Width * TileHeight);
+			bg.a = 0.f;
+			glyph.id = rng.getInt(255);
+		}
+
+		return sprites;
+	}
+
+	void run(const std::string& name, int numChangedCells)
+	{
+		const auto locations = makeLocations();
+		const auto getLocation = [&] (int id) -> const SpriteLocation& { return locations[id]; };
+
+		Rng rng(numChangedCells);
+		auto sprites = makeSprites(rng);
+
+		SpriteBatch batch;
+		batch.setSprites(sprites, getLocation);
+		batch.markUploaded();
+
+		std::size_t numBytes = 0;
+		std::size_t numRanges = 0;
+
+		Benchmark::Timer timer;
+
+		for (int frame = 0; frame < NumFrames; ++frame)
+		{
+			for (int i = 0; i < numChangedCells; ++i)
+			{
+				Sprite& glyph = sprites[2 + rng.getInt(Width * Height - 1) * 2];
+				glyph.id = rng.getInt(255);
+				glyph.g = rng.getInt(255) / 255.f;
+			}
+
+			batch.setSprites(sprites, getLocation);
+
+			for (const auto& range : batch.getChangedRanges())
+				numBytes += range.count * sizeof(SpriteBatch::Vertex);
+
+			numRanges += batch.getChangedRanges().size();
+			batch.markUploaded();
+		}
+
+		Benchmark::report(name, timer.getSeconds(), NumFrames, "frame");
+
+		std::cout << "    float vertices " << sprites.size() * FloatSpriteBytes
+			<< " B/frame, instanced " << sprites.size() * InstanceBytes
+			<< " B/frame, packed " << sprites.size() * 4 * sizeof(SpriteBatch::Vertex)
+			<< " B/frame, changed ranges " << numBytes / NumFrames
+			<< " B/frame in " << numRanges / NumFrames << " uploads\n";
+	}
+}
+
+int main()
+{
+	run("Idle console", 0);
+
+	for (const int numChangedCells : { 1, 10, 100, 1000 })
+		run(std::to_string(numChangedCells) + " changed cells", numChangedCells);
+
+	return 0;
+}
@@ -3,54 +3,74 @@
 #pragma once
 
 #include "Vector2.hpp"
+#include "Direction.hpp"
+#include "PriorityQueue.hpp"
 
 #include <functional>
-#include <queue>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
-class AStar
+struct AStarHeuristic
+{
+	static std::size_t manhattan(const Vec2i& start, const Vec2i& end);
+	static std::size_t euclidean(const Vec2i& start, const Vec2i& end);
+	static std::size_t octagonal(const Vec2i& start, const Vec2i& end);
+	static std::size_t roguelike(const Vec2i& start, const Vec2i& end);
+
+	// Function object the compiler can inline, the default for BasicAStar
+	struct Roguelike
+	{
+		std::size_t operator()(const Vec2i& start, const Vec2i& end) const;
+	};
+};
+
+// The predicates are template parameters so they can be inlined into the search loop.
+// Plain lambdas or function objects reading a grid directly are the fastest choice.
+template <typename PassableFn, typename HeuristicFn = AStarHeuristic::Roguelike>
+class BasicAStar
 {
 public:
-	using PassableFunction = std::function<bool(Vec2i)>;
-	using HeuristicFunction = std::function<std::size_t(Vec2i, Vec2i)>;
+	using PassableFunction = PassableFn;
+	using HeuristicFunction = HeuristicFn;
+	using Heuristic = AStarHeuristic;
 
-	struct Heuristic
+	enum class OpenSet
 	{
-		static std::size_t manhattan(const Vec2i& start, const Vec2i& end);
-		static std::size_t euclidean(const Vec2i& start, const Vec2i& end);
-		static std::size_t octagonal(const Vec2i& start, const Vec2i& end);
-		static std::size_t roguelike(const Vec2i& start, const Vec2i& end);
+		BinaryHeap,
+		Buckets, // Path costs are small integers, so a bucket queue finds the same paths faster
 	};
 
 public:
-	AStar(int width, int height, PassableFunction isPassable);
+	BasicAStar(int width, int height, PassableFunction isPassable);
+	BasicAStar(int width, int height, PassableFunction isPassable, HeuristicFunction heuristic);
 
+	void setPassable(PassableFunction isPassable);
 	void setMaxCost(std::size_t maxCost); // Max search depth
 	void setHeuristic(HeuristicFunction heuristic);
+	void setOpenSet(OpenSet openSet);
 
 	std::vector<Vec2i> findPath(const Vec2i& start, const Vec2i& end);
 
-private:
-	struct OpenNode
-	{
-		Vec2i position;
-		std::size_t score;
-
-		bool operator<(const OpenNode& b) const
-		{
-			return score > b.score;
-		}
-	};
+	std::size_t getNumExpanded() const; // Nodes expanded by the last query
 
+private:
 	struct Cell
 	{
 		Vec2i parent;
 		std::size_t cost;
 		bool visited;
+		unsigned int generation; // Cells from older queries count as unvisited
 	};
 
+	static HeuristicFunction getDefaultHeuristic();
+
 	Cell& cell(const Vec2i& position);
 	const Cell& cell(const Vec2i& position) const;
 
+	template <typename Queue>
+	std::vector<Vec2i> search(Queue& openSet, const Vec2i& start, const Vec2i& end);
+
 	void clear();
 	bool isInBounds(const Vec2i& position) const;
 
@@ -58,42 +78,218 @@ private:
 	int m_width;
 	int m_height;
 	std::size_t m_maxCost;
+	unsigned int m_generation = 0;
+	std::size_t m_numExpanded = 0;
 	std::vector<Cell> m_cells;
-	std::priority_queue<OpenNode, std::vector<OpenNode>> m_openSet;
+	OpenSet m_openSet = OpenSet::BinaryHeap;
+	// The storage of the open sets is reused between queries
+	BinaryHeap<Vec2i> m_binaryHeap;
+	BucketQueue<Vec2i> m_buckets;
 	PassableFunction m_isPassable;
 	HeuristicFunction m_heuristic;
 };
 
-inline std::size_t AStar::Heuristic::manhattan(const Vec2i& start, const Vec2i& end)
+// Type-erased version, used when the predicates are only known at runtime
+using AStar = BasicAStar<std::function<bool(Vec2i)>, std::function<std::size_t(Vec2i, Vec2i)>>;
+
+extern template class BasicAStar<std::function<bool(Vec2i)>, std::function<std::size_t(Vec2i, Vec2i)>>;
+
+inline std::size_t AStarHeuristic::manhattan(const Vec2i& start, const Vec2i& end)
 {
 	const Vec2i delta = end - start;
 	return 10 * (std::abs(delta.x) + std::abs(delta.y));
 }
 
-inline std::size_t AStar::Heuristic::euclidean(const Vec2i& start, const Vec2i& end)
+inline std::size_t AStarHeuristic::euclidean(const Vec2i& start, const Vec2i& end)
 {
 	const Vec2i delta = end - start;
 	return static_cast<std::size_t>(10 * std::sqrt(delta.x * delta.x + delta.y * delta.y));
 }
 
-inline std::size_t AStar::Heuristic::octagonal(const Vec2i& start, const Vec2i& end)
+inline std::size_t AStarHeuristic::octagonal(const Vec2i& start, const Vec2i& end)
 {
 	const Vec2i delta = { std::abs(end.x - start.x), std::abs(end.y - start.y) };
 	return 10 * (delta.x + delta.y) - 6 * std::min(delta.x, delta.y);
 }
 
-inline std::size_t AStar::Heuristic::roguelike(const Vec2i& start, const Vec2i& end)
+inline std::size_t AStarHeuristic::roguelike(const Vec2i& start, const Vec2i& end)
 {
 	const Vec2i delta = { std::abs(end.x - start.x), std::abs(end.y - start.y) };
 	return 10 * std::max(delta.x, delta.y);
 }
 
-inline AStar::Cell& AStar::cell(const Vec2i& position)
+inline std::size_t AStarHeuristic::Roguelike::operator()(const Vec2i& start, const Vec2i& end) const
 {
-	return m_cells[position.x + position.y * m_width];
+	return roguelike(start, end);
+}
+
+template <typename PassableFn, typename HeuristicFn>
+BasicAStar<PassableFn, HeuristicFn>::BasicAStar(int width, int height, PassableFunction isPassable)
+	: BasicAStar(width, height, std::move(isPassable), getDefaultHeuristic())
+{
+}
+
+template <typename PassableFn, typename HeuristicFn>
+BasicAStar<PassableFn, HeuristicFn>::BasicAStar(int width, int height, PassableFunction isPassable, HeuristicFunction heuristic)
+	: m_width(width)
+	, m_height(height)
+	, m_maxCost(std::numeric_limits<decltype(m_maxCost)>::max())
+	, m_cells(width * height, Cell{ {}, 0, false, 0 })
+	, m_isPassable(std::move(isPassable))
+	, m_heuristic(std::move(heuristic))
+{
+}
+
+template <typename PassableFn, typename HeuristicFn>
+void BasicAStar<PassableFn, HeuristicFn>::setPassable(PassableFunction isPassable)
+{
+	m_isPassable = std::move(isPassable);
+}
+
+template <typename PassableFn, typename HeuristicFn>
+void BasicAStar<PassableFn, HeuristicFn>::setMaxCost(std::size_t maxCost)
+{
+	m_maxCost = maxCost * 10;
+}
+
+template <typename PassableFn, typename HeuristicFn>
+void BasicAStar<PassableFn, HeuristicFn>::setHeuristic(HeuristicFunction heuristic)
+{
+	m_heuristic = std::move(heuristic);
+}
+
+template <typename PassableFn, typename HeuristicFn>
+void BasicAStar<PassableFn, HeuristicFn>::setOpenSet(OpenSet openSet)
+{
+	m_openSet = openSet;
+}
+
+template <typename PassableFn, typename HeuristicFn>
+std::vector<Vec2i> BasicAStar<PassableFn, HeuristicFn>::findPath(const Vec2i& start, const Vec2i& end)
+{
+	clear();
+
+	if (m_openSet == OpenSet::Buckets)
+		return search(m_buckets, start, end);
+
+	return search(m_binaryHeap, start, end);
+}
+
+template <typename PassableFn, typename HeuristicFn>
+std::size_t BasicAStar<PassableFn, HeuristicFn>::getNumExpanded() const
+{
+	return m_numExpanded;
+}
+
+template <typename PassableFn, typename HeuristicFn>
+HeuristicFn BasicAStar<PassableFn, HeuristicFn>::getDefaultHeuristic()
+{
+	// std::function and function pointers get the roguelike heuristic, function objects are default constructed
+	if constexpr (std::is_constructible_v<HeuristicFunction, decltype(&Heuristic::roguelike)>)
+		return &Heuristic::roguelike;
+	else
+		return HeuristicFunction();
 }
 
-inline const AStar::Cell& AStar::cell(const Vec2i& position) const
+template <typename PassableFn, typename HeuristicFn>
+typename BasicAStar<PassableFn, HeuristicFn>::Cell& BasicAStar<PassableFn, HeuristicFn>::cell(const Vec2i& position)
+{
+	Cell& cell = m_cells[position.x + position.y * m_width];
+
+	if (cell.generation != m_generation)
+		cell = { {}, m_maxCost, false, m_generation };
+
+	return cell;
+}
+
+template <typename PassableFn, typename HeuristicFn>
+const typename BasicAStar<PassableFn, HeuristicFn>::Cell& BasicAStar<PassableFn, HeuristicFn>::cell(const Vec2i& position) const
 {
 	return m_cells[position.x + position.y * m_width];
 }
+
+template <typename PassableFn, typename HeuristicFn>
+template <typename Queue>
+std::vector<Vec2i> BasicAStar<PassableFn, HeuristicFn>::search(Queue& openSet, const Vec2i& start, const Vec2i& end)
+{
+	static const auto& directions = Direction::All;
+	static constexpr std::array<int, 8> directionCost =
+	{
+		14, 10, 14,
+		10,     10,
+		14, 10, 14,
+	};
+
+	openSet.clear();
+	openSet.push(0, start);
+	cell(start).cost = 0;
+
+	while (!openSet.isEmpty())
+	{
+		Vec2i current = openSet.pop();
+		++m_numExpanded;
+
+		if (current == end)
+		{
+			std::vector<Vec2i> path;
+
+			while (current != start)
+			{
+				path.emplace_back(current);
+				current = cell(current).parent;
+			}
+
+			path.emplace_back(start);
+			//std::reverse(path.begin(), path.end());
+
+			return path;
+		}
+
+		Cell& currentCell = cell(current);
+		currentCell.visited = true;
+
+		for (std::size_t i = 0; i < directions.size(); ++i)
+		{
+			const Vec2i next = current + directions[i];
+
+			if (!isInBounds(next) || !m_isPassable(next))
+				continue;
+
+			Cell& nextCell = cell(next);
+
+			if (nextCell.visited)
+				continue;
+
+			const std::size_t newCost = currentCell.cost + directionCost[i];
+
+			if (newCost < nextCell.cost)
+			{
+				openSet.push(newCost + m_heuristic(next, end), next);
+				nextCell.cost = newCost;
+				nextCell.parent = current;
+			}
+		}
+	}
+
+	return {};
+}
+
+template <typename PassableFn, typename HeuristicFn>
+void BasicAStar<PassableFn, HeuristicFn>::clear()
+{
+	m_numExpanded = 0;
+
+	// Bumping the generation lazily resets every cell, see cell().
+	// Only when the counter wraps around do the stale stamps need to be wiped.
+	if (++m_generation == 0)
+	{
+		std::fill(m_cells.begin(), m_cells.end(), Cell{ {}, 0, false, 0 });
+		m_generation = 1;
+	}
+}
+
+template <typename PassableFn, typename HeuristicFn>
+bool BasicAStar<PassableFn, HeuristicFn>::isInBounds(const Vec2i& position) const
+{
+	return position.x >= 0 && position.x < m_width && position.y >= 0 && position.y < m_height;
+}
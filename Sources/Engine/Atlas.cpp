@@ -2,9 +2,52 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm> // min, max
+#include <cstdint>
+#include <cstring> // memcpy
+#include <fstream>
+
 #define STB_RECT_PACK_IMPLEMENTATION
 #include "stb/stb_rect_pack.h"
 
+namespace
+{
+	// Native byte order, a cache written on another machine fails the magic check
+	struct CacheHeader
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t keySize;
+		std::uint32_t numLocations;
+		std::uint32_t atlasSize;
+	};
+
+	constexpr std::uint32_t CacheMagic = 0x43544c41; // "ALTC"
+	constexpr std::uint32_t CacheVersion = 1;
+
+	// The key is padded so the locations and pixels that follow are aligned
+	std::size_t getPaddedSize(std::size_t size)
+	{
+		return (size + 3) & ~std::size_t(3);
+	}
+
+	SDL_Surface* createSurface(int width, int height)
+	{
+		return SDL_CreateRGBSurface(0, width, height, 32,
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff
+#else
+			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000
+#endif
+		);
+	}
+}
+
+bool Atlas::Region::isEmpty() const
+{
+	return w <= 0 || h <= 0;
+}
+
 Atlas::~Atlas()
 {
 	if (m_atlas)
@@ -18,13 +61,6 @@ Atlas::~Atlas()
    and its current location in the texture atlas */
 int Atlas::addSurface(SDL_Surface* surface)
 {
-	// The previous atlas is no longer valid
-	if (m_atlas)
-	{
-		SDL_FreeSurface(m_atlas);
-		m_atlas = nullptr;
-	}
-
 	const int id = m_sources.size();
 	m_sources.push_back(surface);
 	SpriteLocation& loc = m_mapping.emplace_back();
@@ -33,84 +69,260 @@ int Atlas::addSurface(SDL_Surface* surface)
 	loc.x1 = +0.5f * surface->w;
 	loc.y1 = +0.5f * surface->h;
 	// s0,t0,s1,t1 will be filled in during the packing phase
+	m_revisions.push_back(0);
 
 	return id;
 }
 
-/* If the surface hasn't been built, or if the set of sprites has
-   changed, build the surface, and return it. */
+void Atlas::updateSurface(int id, SDL_Surface* surface)
+{
+	// The pixels of a cached atlas can't be written to
+	if (m_cache.isOpen())
+		restoreSources();
+
+	SDL_FreeSurface(m_sources[id]);
+	m_sources[id] = surface;
+	++m_revisions[id];
+
+	// Same place in the atlas, unless it is packed again anyway
+	if (m_atlas && static_cast<std::size_t>(id) < m_numPacked)
+	{
+		const SpriteLocation& loc = m_mapping[id];
+		blit(id, static_cast<int>(loc.s0 * m_atlasSize + 0.5f), static_cast<int>(loc.t0 * m_atlasSize + 0.5f));
+	}
+}
+
+unsigned Atlas::getRevision(int id) const
+{
+	return m_revisions[id];
+}
+
+int Atlas::getNumSurfaces() const
+{
+	return static_cast<int>(m_sources.size());
+}
+
+/* If the surface hasn't been built, build it. Surfaces added since then
+   go into the space left, the atlas only grows when they don't fit. */
 SDL_Surface* Atlas::getSurface()
 {
 	if (!m_atlas)
+		grow();
+
+	else if (m_numPacked < m_sources.size())
 	{
-		std::vector<stbrp_rect> rects(m_sources.size());
-		std::vector<stbrp_node> workingSpace;
-		stbrp_context context;
-		int atlasSize = 1;
+		// A cached atlas has no skyline to pack into, it is packed again with the new surfaces
+		if (m_cache.isOpen())
+			restoreSources();
 
-		for (std::size_t i = 0; i < rects.size(); ++i)
-		{
-			rects[i].id = i;
-			rects[i].w = m_sources[i]->w;
-			rects[i].h = m_sources[i]->h;
+		if (!m_atlas || !pack(m_numPacked))
+			grow();
+	}
 
-			while (atlasSize < rects[i].w || atlasSize < rects[i].h)
-				atlasSize *= 2;
-		}
+	return m_atlas;
+}
 
-		bool success = false;
-		while (!success)
-		{
-			workingSpace.resize(atlasSize);
-			stbrp_init_target(&context, atlasSize, atlasSize, workingSpace.data(), workingSpace.size());
-			stbrp_pack_rects(&context, rects.data(), rects.size());
-
-			success = true;
-			for (const auto& rect : rects)
-			{
-				if (!rect.was_packed)
-				{
-					success = false;
-					atlasSize *= 2;
-					break;
-				}
-			}
-		}
+const SpriteLocation& Atlas::getLocation(int id) const
+{
+	return m_mapping[id];
+}
+
+bool Atlas::saveCache(const std::string& path, std::string_view key)
+{
+	SDL_Surface* atlas = getSurface();
 
-		m_atlas = SDL_CreateRGBSurface(0, atlasSize, atlasSize, 32,
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+
+	const CacheHeader header = { CacheMagic, CacheVersion, static_cast<std::uint32_t>(key.size()),
+		static_cast<std::uint32_t>(m_mapping.size()), static_cast<std::uint32_t>(m_atlasSize) };
+	const char padding[4] = {};
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(key.data(), key.size());
+	file.write(padding, getPaddedSize(key.size()) - key.size());
+	file.write(reinterpret_cast<const char*>(m_mapping.data()), m_mapping.size() * sizeof(SpriteLocation));
+
+	for (int y = 0; y < m_atlasSize; ++y)
+		file.write(static_cast<const char*>(atlas->pixels) + y * atlas->pitch, m_atlasSize * 4);
+
+	return static_cast<bool>(file);
+}
+
+bool Atlas::loadCache(const std::string& path, std::string_view key)
+{
+	if (!m_sources.empty() || !m_cache.open(path))
+		return false;
+
+	const auto* data = static_cast<const std::uint8_t*>(m_cache.getData());
+	const std::size_t size = m_cache.getSize();
+
+	CacheHeader header;
+	const std::size_t keyOffset = sizeof(header);
+	const std::size_t locationsOffset = keyOffset + getPaddedSize(key.size());
+
+	if (size >= sizeof(header))
+		std::memcpy(&header, data, sizeof(header));
+
+	// Any mismatch, including a truncated file, means the atlas is built again
+	const bool valid = size >= locationsOffset
+		&& header.magic == CacheMagic
+		&& header.version == CacheVersion
+		&& header.keySize == key.size()
+		&& std::memcmp(data + keyOffset, key.data(), key.size()) == 0
+		&& size == locationsOffset + header.numLocations * sizeof(SpriteLocation) + std::size_t(header.atlasSize) * header.atlasSize * 4;
+
+	if (!valid)
+	{
+		m_cache.close();
+		return false;
+	}
+
+	const auto* locations = reinterpret_cast<const SpriteLocation*>(data + locationsOffset);
+	const auto* pixels = reinterpret_cast<const std::uint8_t*>(locations + header.numLocations);
+
+	m_atlasSize = header.atlasSize;
+	m_mapping.assign(locations, locations + header.numLocations);
+	m_sources.assign(header.numLocations, nullptr); // Only needed if the atlas is packed again
+	m_revisions.assign(header.numLocations, 0);
+	m_numPacked = m_sources.size();
+
+	// Read only, restoreSources() replaces it before anything is blitted
+	m_atlas = SDL_CreateRGBSurfaceFrom(const_cast<std::uint8_t*>(pixels), m_atlasSize, m_atlasSize, 32, m_atlasSize * 4,
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-			0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff
+		0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff
 #else
-			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000
+		0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000
 #endif
-		);
+	);
+
+	m_resized = true;
+	m_changedRegion = { 0, 0, m_atlasSize, m_atlasSize };
+
+	return true;
+}
+
+bool Atlas::isResized() const
+{
+	return m_resized;
+}
+
+const Atlas::Region& Atlas::getChangedRegion() const
+{
+	return m_changedRegion;
+}
+
+void Atlas::markUploaded()
+{
+	m_changedRegion = {};
+	m_resized = false;
+}
+
+bool Atlas::pack(std::size_t first)
+{
+	m_rects.resize(m_sources.size() - first);
+
+	for (std::size_t i = 0; i < m_rects.size(); ++i)
+	{
+		m_rects[i] = {};
+		m_rects[i].id = static_cast<int>(first + i);
+		m_rects[i].w = m_sources[first + i]->w;
+		m_rects[i].h = m_sources[first + i]->h;
+	}
 
-		for (std::size_t i = 0; i < rects.size(); ++i)
+	// The skyline keeps its state, new rects only use the space above it
+	if (!stbrp_pack_rects(&m_context, m_rects.data(), m_rects.size()))
+		return false;
+
+	for (const auto& rect : m_rects)
+		blit(rect.id, rect.x, rect.y);
+
+	m_numPacked = m_sources.size();
+
+	return true;
+}
+
+void Atlas::grow()
+{
+	for (const auto* surface : m_sources)
+		while (m_atlasSize < surface->w || m_atlasSize < surface->h)
+			m_atlasSize *= 2;
+
+	// Doubling keeps the total cost of repacking linear in the number of surfaces
+	do
+	{
+		if (m_atlas)
 		{
-			SDL_Surface* surface = m_sources[i];
-			SDL_Rect dstRect;
-			dstRect.x = rects[i].x;
-			dstRect.y = rects[i].y;
-			dstRect.w = surface->w;
-			dstRect.h = surface->h;
-
-			SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
-			SDL_BlitSurface(surface, nullptr, m_atlas, &dstRect);
-
-			for (std::size_t j = 0; j < m_mapping.size(); ++j)
-			{
-				m_mapping[i].s0 = static_cast<float>(dstRect.x) / atlasSize;
-				m_mapping[i].t0 = static_cast<float>(dstRect.y) / atlasSize;
-				m_mapping[i].s1 = static_cast<float>(dstRect.x + dstRect.w) / atlasSize;
-				m_mapping[i].t1 = static_cast<float>(dstRect.y + dstRect.h) / atlasSize;
-			}
+			SDL_FreeSurface(m_atlas);
+			m_atlasSize *= 2;
 		}
+
+		m_atlas = createSurface(m_atlasSize, m_atlasSize);
+
+		m_nodes.resize(m_atlasSize);
+		stbrp_init_target(&m_context, m_atlasSize, m_atlasSize, m_nodes.data(), m_nodes.size());
+		m_changedRegion = {};
 	}
+	while (!pack(0));
 
-	return m_atlas;
+	m_resized = true;
+	m_changedRegion = { 0, 0, m_atlasSize, m_atlasSize };
 }
 
-const SpriteLocation& Atlas::getLocation(int id) const
+void Atlas::blit(std::size_t id, int x, int y)
 {
-	return m_mapping[id];
+	SDL_Surface* surface = m_sources[id];
+	SDL_Rect dstRect;
+	dstRect.x = x;
+	dstRect.y = y;
+	dstRect.w = surface->w;
+	dstRect.h = surface->h;
+
+	SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+	SDL_BlitSurface(surface, nullptr, m_atlas, &dstRect);
+
+	SpriteLocation& loc = m_mapping[id];
+	loc.s0 = static_cast<float>(dstRect.x) / m_atlasSize;
+	loc.t0 = static_cast<float>(dstRect.y) / m_atlasSize;
+	loc.s1 = static_cast<float>(dstRect.x + dstRect.w) / m_atlasSize;
+	loc.t1 = static_cast<float>(dstRect.y + dstRect.h) / m_atlasSize;
+
+	// Bounding box of everything blitted since the last upload
+	if (m_changedRegion.isEmpty())
+		m_changedRegion = { dstRect.x, dstRect.y, dstRect.w, dstRect.h };
+	else
+	{
+		const int left = std::min(m_changedRegion.x, dstRect.x);
+		const int top = std::min(m_changedRegion.y, dstRect.y);
+		const int right = std::max(m_changedRegion.x + m_changedRegion.w, dstRect.x + dstRect.w);
+		const int bottom = std::max(m_changedRegion.y + m_changedRegion.h, dstRect.y + dstRect.h);
+
+		m_changedRegion = { left, top, right - left, bottom - top };
+	}
+}
+
+void Atlas::restoreSources()
+{
+	const auto* pixels = static_cast<const std::uint8_t*>(m_atlas->pixels);
+
+	for (std::size_t id = 0; id < m_numPacked; ++id)
+	{
+		const SpriteLocation& loc = m_mapping[id];
+		const int x = static_cast<int>(loc.s0 * m_atlasSize + 0.5f);
+		const int y = static_cast<int>(loc.t0 * m_atlasSize + 0.5f);
+		const int w = static_cast<int>(loc.x1 - loc.x0);
+		const int h = static_cast<int>(loc.y1 - loc.y0);
+
+		SDL_Surface* surface = createSurface(w, h);
+
+		for (int row = 0; row < h; ++row)
+			std::memcpy(static_cast<std::uint8_t*>(surface->pixels) + row * surface->pitch, pixels + (y + row) * m_atlas->pitch + x * 4, w * 4);
+
+		m_sources[id] = surface;
+	}
+
+	SDL_FreeSurface(m_atlas);
+	m_atlas = nullptr;
+	m_cache.close();
 }
@@ -2,6 +2,11 @@
 
 #pragma once
 
+#include "MappedFile.hpp"
+#include "stb/stb_rect_pack.h"
+
+#include <string>
+#include <string_view>
 #include <vector>
 
 struct SDL_Surface;
@@ -12,18 +17,63 @@ struct SpriteLocation
 	float s0, t0, s1, t1; // Corners in texture coordinates
 };
 
+// Surfaces are packed into the free skyline space left by the earlier ones,
+// the whole atlas is only packed again when it has to grow.
 class Atlas
 {
+public:
+	// Part of the atlas surface, in pixels
+	struct Region
+	{
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+
+		bool isEmpty() const;
+	};
+
 public:
 	Atlas() = default;
 	~Atlas();
 
+	Atlas(const Atlas&) = delete;
+	Atlas& operator=(const Atlas&) = delete;
+
 	int addSurface(SDL_Surface* surface);
-	SDL_Surface* getSurface();
+	void updateSurface(int id, SDL_Surface* surface); // Same size as the one it replaces
+	unsigned getRevision(int id) const; // Bumped by updateSurface()
+	int getNumSurfaces() const;
+	SDL_Surface* getSurface(); // Packs the surfaces added since the last call
 	const SpriteLocation& getLocation(int id) const;
 
+	// The packed pixels and locations, valid while the key (font, size, glyphs...) is the same.
+	// A loaded atlas uses the file's pixels in place, new surfaces can still be added after.
+	bool saveCache(const std::string& path, std::string_view key);
+	bool loadCache(const std::string& path, std::string_view key); // Into an empty atlas
+
+	// Changes to the surface since the last markUploaded(), see Renderer
+	bool isResized() const; // A new surface, every location moved
+	const Region& getChangedRegion() const;
+	void markUploaded();
+
+private:
+	bool pack(std::size_t first); // Packs m_sources[first...] into the current skyline
+	void grow();
+	void blit(std::size_t id, int x, int y);
+	void restoreSources(); // Copies the glyphs of a cached atlas out of the file
+
 private:
 	SDL_Surface* m_atlas = nullptr;
+	int m_atlasSize = 1;
 	std::vector<SDL_Surface*> m_sources;
 	std::vector<SpriteLocation> m_mapping;
+	std::vector<unsigned> m_revisions;
+	std::size_t m_numPacked = 0;
+	stbrp_context m_context;
+	std::vector<stbrp_node> m_nodes;
+	std::vector<stbrp_rect> m_rects; // Scratch
+	MappedFile m_cache; // Holds the pixels of a loaded atlas
+	Region m_changedRegion;
+	bool m_resized = false;
 };
@@ -0,0 +1,88 @@
+#include "BitGrid.hpp"
+
+#include <cassert>
+#include <cstring> // memset
+#include <utility> // swap
+
+BitGrid::BitGrid(int width, int height, bool value)
+	: m_width(width)
+	, m_height(height)
+	, m_words((width * height + WordBits - 1) / WordBits)
+{
+	fill(value);
+}
+
+int BitGrid::getWidth() const
+{
+	return m_width;
+}
+
+int BitGrid::getHeight() const
+{
+	return m_height;
+}
+
+std::size_t BitGrid::getSize() const
+{
+	return static_cast<std::size_t>(m_width * m_height);
+}
+
+void BitGrid::fill(bool value)
+{
+	std::memset(m_words.data(), value ? 0xFF : 0x00, m_words.size() * sizeof(Word));
+
+	if (value)
+		clearPadding();
+}
+
+void BitGrid::swap(BitGrid& other)
+{
+	std::swap(m_width, other.m_width);
+	std::swap(m_height, other.m_height);
+	m_words.swap(other.m_words);
+}
+
+BitGrid& BitGrid::operator|=(const BitGrid& other)
+{
+	merge(other, 0, m_height - 1);
+
+	return *this;
+}
+
+void BitGrid::merge(const BitGrid& other, int top, int bottom)
+{
+	assert(m_words.size() == other.m_words.size());
+
+	if (top > bottom)
+		return;
+
+	const std::size_t first = static_cast<std::size_t>(top * m_width) / WordBits;
+	const std::size_t last = static_cast<std::size_t>((bottom + 1) * m_width - 1) / WordBits;
+
+	for (std::size_t i = first; i <= last; ++i)
+		m_words[i] |= other.m_words[i];
+}
+
+std::size_t BitGrid::getNumWords() const
+{
+	return m_words.size();
+}
+
+BitGrid::Word* BitGrid::getWords()
+{
+	return m_words.data();
+}
+
+const BitGrid::Word* BitGrid::getWords() const
+{
+	return m_words.data();
+}
+
+void BitGrid::clearPadding()
+{
+	// Bits past the last cell stay zero so whole words can be compared and counted
+	const std::size_t used = getSize() % WordBits;
+
+	if (used > 0)
+		m_words.back() &= (Word(1) << used) - 1;
+}
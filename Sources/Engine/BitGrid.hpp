@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Vector2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h> // _BitScanForward64
+#endif
+
+// Dense 2D grid of flags packed into 64-bit words, one bit per cell
+class BitGrid
+{
+public:
+	using Word = std::uint64_t;
+	static constexpr int WordBits = 64;
+
+	// Predicate reading the grid, for BasicFov and BasicAStar
+	struct Reader
+	{
+		const BitGrid* grid = nullptr;
+
+		bool operator()(const Vec2i& position) const;
+	};
+
+public:
+	BitGrid() = default;
+	BitGrid(int width, int height, bool value = false);
+
+	int getWidth() const;
+	int getHeight() const;
+	std::size_t getSize() const;
+
+	bool test(int x, int y) const;
+	bool test(const Vec2i& position) const;
+	bool test(std::size_t i) const;
+
+	void set(int x, int y, bool value);
+	void set(const Vec2i& position, bool value);
+	void set(std::size_t i, bool value);
+
+	void fill(bool value);
+	void swap(BitGrid& other);
+
+	// Whole words at a time, both grids must have the same size
+	BitGrid& operator|=(const BitGrid& other);
+	void merge(const BitGrid& other, int top, int bottom); // Only the words holding rows [top, bottom]
+
+	// Calls function(Vec2i) for every set cell, skipping empty words
+	template <typename Function>
+	void forEach(Function function) const;
+
+	std::size_t getNumWords() const;
+	Word* getWords();
+	const Word* getWords() const;
+
+	static int countTrailingZeros(Word word); // Index of the lowest set bit, word != 0
+
+private:
+	void clearPadding();
+
+private:
+	int m_width = 0;
+	int m_height = 0;
+	std::vector<Word> m_words;
+};
+
+inline bool BitGrid::Reader::operator()(const Vec2i& position) const
+{
+	return grid->test(position);
+}
+
+inline bool BitGrid::test(int x, int y) const
+{
+	return test(static_cast<std::size_t>(x + y * m_width));
+}
+
+inline bool BitGrid::test(const Vec2i& position) const
+{
+	return test(position.x, position.y);
+}
+
+inline bool BitGrid::test(std::size_t i) const
+{
+	return (m_words[i / WordBits] >> (i % WordBits)) & 1;
+}
+
+inline void BitGrid::set(int x, int y, bool value)
+{
+	set(static_cast<std::size_t>(x + y * m_width), value);
+}
+
+inline void BitGrid::set(const Vec2i& position, bool value)
+{
+	set(position.x, position.y, value);
+}
+
+inline void BitGrid::set(std::size_t i, bool value)
+{
+	const Word mask = Word(1) << (i % WordBits);
+
+	if (value)
+		m_words[i / WordBits] |= mask;
+	else
+		m_words[i / WordBits] &= ~mask;
+}
+
+template <typename Function>
+void BitGrid::forEach(Function function) const
+{
+	for (std::size_t w = 0; w < m_words.size(); ++w)
+	{
+		for (Word word = m_words[w]; word != 0; word &= word - 1)
+		{
+			const int i = static_cast<int>(w * WordBits) + countTrailingZeros(word);
+			function(Vec2i(i % m_width, i / m_width));
+		}
+	}
+}
+
+inline int BitGrid::countTrailingZeros(Word word)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
+}
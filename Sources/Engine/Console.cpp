@@ -2,10 +2,79 @@
 
 #include <algorithm> // min, max
 
+namespace
+{
+	// Next code point of a UTF-8 string, U+FFFD for malformed sequences
+	char32_t decodeUtf8(std::string_view string, std::size_t& i)
+	{
+		const auto byte = [&] (std::size_t j) { return static_cast<unsigned char>(string[j]); };
+		const unsigned char lead = byte(i++);
+
+		if (lead < 0x80)
+			return lead;
+
+		const int length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+		char32_t ch = lead & (0x7F >> length);
+
+		for (int k = 1; k < length; ++k, ++i)
+		{
+			if (i >= string.size() || (byte(i) & 0xC0) != 0x80)
+				return U'\uFFFD';
+
+			ch = (ch << 6) | (byte(i) & 0x3F);
+		}
+
+		return length > 1 && ch <= 0x10FFFF ? ch : U'\uFFFD';
+	}
+}
+
 Console::Console(TTF_Font& font, int width, int height)
+	: m_glyphCache(m_atlas, GlyphCacheSize)
 {
+	addGlyphs(font);
+	m_glyphCache.setTileSize(m_tileWidth, m_tileHeight);
+
+	// The sprites are laid out once the tile size is known
 	resize(width, height);
+}
+
+Console::Console(const std::string& fontPath, int fontSize, const std::string& cachePath, int width, int height)
+	: m_glyphCache(m_atlas, GlyphCacheSize)
+{
+	// Everything that changes the pixels of the glyphs
+	const std::string key = fontPath + '\n' + std::to_string(fontSize) + '\n' + std::string(GlyphSet);
+
+	m_atlasCached = m_atlas.loadCache(cachePath, key);
 
+	if (!m_atlasCached)
+	{
+		const bool wasInit = TTF_WasInit();
+		if (!wasInit)
+			TTF_Init();
+
+		TTF_Font* font = TTF_OpenFont(fontPath.c_str(), fontSize);
+		addGlyphs(*font);
+		TTF_CloseFont(font);
+
+		if (!wasInit)
+			TTF_Quit();
+
+		m_atlas.saveCache(cachePath, key);
+	}
+
+	const SpriteLocation& loc = m_atlas.getLocation('A' - Blank);
+	m_tileWidth = static_cast<int>(loc.x1 - loc.x0);
+	m_tileHeight = static_cast<int>(loc.y1 - loc.y0);
+
+	// The font is opened again for the first character outside the atlas
+	m_glyphCache.setFont(fontPath, fontSize);
+	m_glyphCache.setTileSize(m_tileWidth, m_tileHeight);
+
+	resize(width, height);
+}
+
+void Console::addGlyphs(TTF_Font& font)
+{
 	// 95 printable characters
 	constexpr int numGlyphs = Tilde - Blank + 1;
 	for (int i = 0; i < numGlyphs; ++i)
@@ -128,12 +197,12 @@ bool Console::isInBounds(int x, int y) const
 	return x >= 0 && x < m_width && y >= 0 && y < m_height;
 }
 
-char Console::getChar(int x, int y) const
+char32_t Console::getChar(int x, int y) const
 {
 	return m_chars[x + y * m_width];
 }
 
-void Console::setChar(int x, int y, char ch, Color color)
+void Console::setChar(int x, int y, char32_t ch, Color color)
 {
 	if (isInBounds(x, y)) // && ch >= Blank && ch <= Tilde)
 	{
@@ -148,8 +217,9 @@ void Console::setString(int x, int y, std::string_view string, Color color)
 	int dx = 0;
 	int dy = 0;
 
-	for (const char ch : string)
+	for (std::size_t pos = 0; pos < string.size(); )
 	{
+		const char32_t ch = decodeUtf8(string, pos);
 		if (ch == '\t')
 		{
 			for (int i = 0; i < 4; ++i)
@@ -167,6 +237,25 @@ void Console::setString(int x, int y, std::string_view string, Color color)
 	}
 }
 
+void Console::setChars(int left, int top, int width, int height, const char32_t* chars, const Color* colors)
+{
+	const int x0 = std::max(left, 0);
+	const int x1 = std::min(left + width, m_width);
+
+	for (int y = std::max(top, 0); y < std::min(top + height, m_height) && x0 < x1; ++y)
+	{
+		const int src = (x0 - left) + (y - top) * width;
+		std::copy(chars + src, chars + src + (x1 - x0), &m_chars[x0 + y * m_width]);
+		std::copy(colors + src, colors + src + (x1 - x0), &m_colors[x0 + y * m_width]);
+		m_dirty = true;
+	}
+}
+
+Color Console::getColor(int x, int y) const
+{
+	return m_colors[x + y * m_width];
+}
+
 void Console::setColor(int x, int y, Color color)
 {
 	if (isInBounds(x, y))
@@ -183,6 +272,11 @@ void Console::setColor(int left, int top, int width, int height, Color color)
 			setColor(x, y, color);
 }
 
+Color Console::getBgColor(int x, int y) const
+{
+	return m_bgColors[x + y * m_width];
+}
+
 void Console::setBgColor(int x, int y, Color color)
 {
 	if (isInBounds(x, y))
@@ -201,12 +295,12 @@ void Console::setBgColor(int left, int top, int width, int height, Color color)
 
 void Console::drawBox(int left, int top, int width, int height, Color color)
 {
-	constexpr char Horizontal  = 0;
-	constexpr char Vertical    = 1;
-	constexpr char TopLeft     = 2;
-	constexpr char TopRight    = 3;
-	constexpr char BottomLeft  = 4;
-	constexpr char BottomRight = 5;
+	constexpr char32_t Horizontal  = BoxCharacters[0];
+	constexpr char32_t Vertical    = BoxCharacters[1];
+	constexpr char32_t TopLeft     = BoxCharacters[2];
+	constexpr char32_t TopRight    = BoxCharacters[3];
+	constexpr char32_t BottomLeft  = BoxCharacters[4];
+	constexpr char32_t BottomRight = BoxCharacters[5];
 
 	const int right = left + width - 1;
 	const int bottom = top + height - 1;
@@ -229,56 +323,59 @@ void Console::drawBox(int left, int top, int width, int height, Color color)
 	}
 }
 
+bool Console::isAtlasCached() const
+{
+	return m_atlasCached;
+}
+
 Atlas& Console::getAtlas()
 {
 	return m_atlas;
 }
 
+const GlyphCache& Console::getGlyphCache() const
+{
+	return m_glyphCache;
+}
+
 const std::vector<Sprite>& Console::getSprites()
 {
+	m_numChangedCells = 0;
+	m_numRebuiltSprites = 0;
+
 	if (m_dirty)
 	{
-		m_sprites.clear();
-
-		// Draw a background rectangle
-		auto& bg = m_sprites.emplace_back();
-		bg.scaleX = static_cast<float>(m_width);
-		bg.scaleY = static_cast<float>(m_height);
-		bg.r = Black.r / 255.f;
-		bg.g = Black.g / 255.f;
-		bg.b = Black.b / 255.f;
-		bg.a = Black.a / 255.f;
-
+		// Only the sprites of cells that differ from the last frame are patched
 		for (std::size_t i = 0; i < m_chars.size(); ++i)
 		{
-			const auto [y, x] = std::div(i, m_width);
+			const bool bgChanged = m_bgColors[i].toHexRGBA() != m_frontBgColors[i].toHexRGBA();
+			const bool glyphChanged = m_chars[i] != m_frontChars[i] || m_colors[i].toHexRGBA() != m_frontColors[i].toHexRGBA();
 
-			if (m_bgColors[i].a > 0)
+			if (bgChanged)
 			{
-				auto& s = m_sprites.emplace_back();
-				s.x = static_cast<float>(x * m_tileWidth);
-				s.y = static_cast<float>(y * m_tileHeight);
-				s.r = m_bgColors[i].r / 255.f;
-				s.g = m_bgColors[i].g / 255.f;
-				s.b = m_bgColors[i].b / 255.f;
-				s.a = m_bgColors[i].a / 255.f;
+				m_frontBgColors[i] = m_bgColors[i];
+				setBgSprite(i);
+				++m_numRebuiltSprites;
 			}
 
-			// Do not draw whitespace
-			if (m_colors[i].a > 0 && m_chars[i] != Blank)
+			if (glyphChanged)
 			{
-				auto& s = m_sprites.emplace_back();
-				if (m_chars[i] >= Blank)
-					s.id = m_chars[i] - Blank;
-				else // Custom characters
-					s.id = (Tilde - Blank + 1) + m_chars[i];
-				s.x = static_cast<float>(x * m_tileWidth);
-				s.y = static_cast<float>(y * m_tileHeight);
-				s.r = m_colors[i].r / 255.f;
-				s.g = m_colors[i].g / 255.f;
-				s.b = m_colors[i].b / 255.f;
-				s.a = m_colors[i].a / 255.f;
+				// The cache keeps the glyph of a cell until the cell shows something else
+				if (m_chars[i] != m_frontChars[i])
+				{
+					auto& s = m_sprites[i * 2 + 2];
+					m_glyphCache.release(s.id);
+					s.id = getGlyphId(m_chars[i]);
+				}
+
+				m_frontChars[i] = m_chars[i];
+				m_frontColors[i] = m_colors[i];
+				setGlyphSprite(i);
+				++m_numRebuiltSprites;
 			}
+
+			if (bgChanged || glyphChanged)
+				++m_numChangedCells;
 		}
 
 		m_dirty = false;
@@ -287,6 +384,16 @@ const std::vector<Sprite>& Console::getSprites()
 	return m_sprites;
 }
 
+std::size_t Console::getNumChangedCells() const
+{
+	return m_numChangedCells;
+}
+
+std::size_t Console::getNumRebuiltSprites() const
+{
+	return m_numRebuiltSprites;
+}
+
 void Console::resize(int width, int height)
 {
 	if (width < 0)
@@ -294,6 +401,10 @@ void Console::resize(int width, int height)
 	if (height < 0)
 		height = 0;
 
+	// The old sprites no longer hold their glyphs
+	for (std::size_t i = 0; i < m_frontChars.size(); ++i)
+		m_glyphCache.release(m_sprites[i * 2 + 2].id);
+
 	m_width = width;
 	m_height = height;
 
@@ -301,10 +412,78 @@ void Console::resize(int width, int height)
 	m_colors.resize(width * height, White);
 	m_bgColors.resize(width * height, Transparent);
 
-	const std::size_t capacity = width * height * 2 + 1;
-	if (m_sprites.capacity() > capacity)
-		m_sprites.shrink_to_fit();
-	m_sprites.reserve(capacity);
+	m_frontChars.assign(width * height, Blank);
+	m_frontColors.assign(width * height, White);
+	m_frontBgColors.assign(width * height, Transparent);
+
+	m_sprites.assign(width * height * 2 + 1, Sprite());
+	m_sprites.shrink_to_fit();
+
+	// Draw a background rectangle
+	auto& bg = m_sprites[0];
+	bg.scaleX = static_cast<float>(m_width);
+	bg.scaleY = static_cast<float>(m_height);
+	bg.r = Black.r / 255.f;
+	bg.g = Black.g / 255.f;
+	bg.b = Black.b / 255.f;
+	bg.a = Black.a / 255.f;
+
+	// The sprites of a cell never move, they start out matching the front buffer
+	for (std::size_t i = 0; i < m_chars.size(); ++i)
+	{
+		const auto [y, x] = std::div(static_cast<int>(i), m_width);
+
+		for (std::size_t j = 1; j <= 2; ++j)
+		{
+			auto& s = m_sprites[i * 2 + j];
+			s.x = static_cast<float>(x * m_tileWidth);
+			s.y = static_cast<float>(y * m_tileHeight);
+		}
+
+		setBgSprite(i);
+		setGlyphSprite(i);
+	}
 
 	m_dirty = true;
 }
+
+int Console::getGlyphId(char32_t ch)
+{
+	if (ch >= Blank && ch <= Tilde)
+		return ch - Blank;
+
+	for (int i = 0; i < 6; ++i)
+		if (ch == BoxCharacters[i])
+			return (Tilde - Blank + 1) + i;
+
+	const int id = m_glyphCache.acquire(ch);
+
+	return id >= 0 ? id : Question - Blank;
+}
+
+void Console::setBgSprite(std::size_t i)
+{
+	// A transparent background is simply drawn with no alpha
+	auto& s = m_sprites[i * 2 + 1];
+	s.r = m_frontBgColors[i].r / 255.f;
+	s.g = m_frontBgColors[i].g / 255.f;
+	s.b = m_frontBgColors[i].b / 255.f;
+	s.a = m_frontBgColors[i].a / 255.f;
+}
+
+void Console::setGlyphSprite(std::size_t i)
+{
+	auto& s = m_sprites[i * 2 + 2];
+
+	// Do not draw whitespace
+	if (m_frontChars[i] == Blank)
+	{
+		s.a = 0.f;
+		return;
+	}
+
+	s.r = m_frontColors[i].r / 255.f;
+	s.g = m_frontColors[i].g / 255.f;
+	s.b = m_frontColors[i].b / 255.f;
+	s.a = m_frontColors[i].a / 255.f;
+}
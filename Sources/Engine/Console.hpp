@@ -1,14 +1,17 @@
 #pragma once
 
 #include "Atlas.hpp"
+#include "GlyphCache.hpp"
 #include "Renderer.hpp"
 #include "Color.hpp"
 
 #include <SDL2/SDL_ttf.h>
 
+#include <string>
 #include <string_view>
 
-// Virtual console
+// Virtual console of Unicode code points. Printable ASCII and the box-drawing characters
+// are baked into the atlas, other characters are rasterized on first use (see GlyphCache).
 class Console
 {
 private:
@@ -17,7 +20,9 @@ private:
 	static constexpr Color Transparent = { 0, 0, 0, 0 };
 
 public:
-	Console(TTF_Font& font, int width, int height);
+	Console(TTF_Font& font, int width, int height); // Only the baked characters, others show as '?'
+	// Loads the glyphs from the atlas cache, the font is only opened when it is missing or stale
+	Console(const std::string& fontPath, int fontSize, const std::string& cachePath, int width, int height);
 
 	int getWidth() const;
 	int getHeight() const;
@@ -29,36 +34,68 @@ public:
 	void clear(int left, int top, int width, int height, Color bgColor = Black);
 	bool isInBounds(int x, int y) const;
 
-	char getChar(int x, int y) const;
-	void setChar(int x, int y, char ch, Color color = White);
-	void setString(int x, int y, std::string_view string, Color color = White);
+	char32_t getChar(int x, int y) const;
+	void setChar(int x, int y, char32_t ch, Color color = White);
+	void setString(int x, int y, std::string_view string, Color color = White); // UTF-8
+	void setChars(int left, int top, int width, int height, const char32_t* chars, const Color* colors); // Row by row
 
+	Color getColor(int x, int y) const;
 	void setColor(int x, int y, Color color);
 	void setColor(int left, int top, int width, int height, Color color);
 
+	Color getBgColor(int x, int y) const;
 	void setBgColor(int x, int y, Color color);
 	void setBgColor(int left, int top, int width, int height, Color color);
 
 	void drawBox(int left, int top, int width, int height, Color color = White);
 
+	bool isAtlasCached() const; // The glyphs came from the cache file
 	Atlas& getAtlas();
+	const GlyphCache& getGlyphCache() const;
 	const std::vector<Sprite>& getSprites();
 
+	// Work done by the last getSprites()
+	std::size_t getNumChangedCells() const;
+	std::size_t getNumRebuiltSprites() const;
+
 private:
+	void addGlyphs(TTF_Font& font);
 	void resize(int width, int height);
+	int getGlyphId(char32_t ch);
+	void setBgSprite(std::size_t i);
+	void setGlyphSprite(std::size_t i);
 
 private:
 	static constexpr int Blank = 0x20; // ' '
 	static constexpr int Tilde = 0x7E; // '~'
+	static constexpr int Question = 0x3F; // '?', for characters that can't be shown
+
+	// Drawn by addGlyphs() rather than taken from the font, in this order
+	static constexpr char32_t BoxCharacters[] = { U'─', U'│', U'┌', U'┐', U'└', U'┘' };
+
+	// Tiles for the characters outside the baked ones, about 300 KB of atlas at 12x24
+	static constexpr std::size_t GlyphCacheSize = 256;
+
+	// Glyphs of addGlyphs(), part of the cache key
+	static constexpr std::string_view GlyphSet = "ascii 0x20-0x7E, box 6, blank filled";
 
 	int m_width = 0;
 	int m_height = 0;
 	int m_tileWidth = 0;
 	int m_tileHeight = 0;
 	Atlas m_atlas;
-	std::vector<char> m_chars;
+	bool m_atlasCached = false;
+	GlyphCache m_glyphCache;
+	std::vector<char32_t> m_chars;
 	std::vector<Color> m_colors;
 	std::vector<Color> m_bgColors;
+	// What the sprites currently show, compared against the cells above
+	std::vector<char32_t> m_frontChars;
+	std::vector<Color> m_frontColors;
+	std::vector<Color> m_frontBgColors;
+	// The background rectangle, then a background and a glyph sprite per cell
 	std::vector<Sprite> m_sprites;
+	std::size_t m_numChangedCells = 0;
+	std::size_t m_numRebuiltSprites = 0;
 	bool m_dirty = true;
 };
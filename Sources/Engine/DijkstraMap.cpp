@@ -0,0 +1,108 @@
+#include "DijkstraMap.hpp"
+#include "Direction.hpp"
+
+#include <algorithm> // fill
+#include <limits>
+
+DijkstraMap::DijkstraMap(int width, int height, PassableFunction isPassable)
+	: m_width(width)
+	, m_height(height)
+	, m_maxCost(std::numeric_limits<decltype(m_maxCost)>::max())
+	, m_cells(width * height)
+	, m_isPassable(std::move(isPassable))
+{
+}
+
+void DijkstraMap::setMaxCost(std::size_t maxCost)
+{
+	m_maxCost = maxCost * 10;
+	m_valid = false;
+}
+
+void DijkstraMap::compute(const Vec2i& goal)
+{
+	static const auto& directions = Direction::All;
+	static constexpr std::array<int, 8> directionCost =
+	{
+		14, 10, 14,
+		10,     10,
+		14, 10, 14,
+	};
+
+	std::fill(m_cells.begin(), m_cells.end(), Cell{ {}, m_maxCost });
+
+	m_goal = goal;
+	m_valid = true;
+
+	if (!isInBounds(goal))
+		return;
+
+	cell(goal) = { goal, 0 };
+	m_openSet.push({ goal, 0 });
+
+	while (!m_openSet.empty())
+	{
+		const OpenNode current = m_openSet.top();
+		m_openSet.pop();
+
+		// Skip stale entries
+		if (current.cost > cell(current.position).cost)
+			continue;
+
+		for (std::size_t i = 0; i < directions.size(); ++i)
+		{
+			const Vec2i next = current.position + directions[i];
+
+			if (!isInBounds(next) || !m_isPassable(next))
+				continue;
+
+			Cell& nextCell = cell(next);
+			const std::size_t newCost = current.cost + directionCost[i];
+
+			if (newCost < nextCell.cost)
+			{
+				m_openSet.push({ next, newCost });
+				nextCell.cost = newCost;
+				nextCell.next = current.position;
+			}
+		}
+	}
+}
+
+void DijkstraMap::invalidate()
+{
+	m_valid = false;
+}
+
+bool DijkstraMap::isValid() const
+{
+	return m_valid;
+}
+
+const Vec2i& DijkstraMap::getGoal() const
+{
+	return m_goal;
+}
+
+bool DijkstraMap::isReachable(const Vec2i& position) const
+{
+	return isInBounds(position) && cell(position).cost < m_maxCost;
+}
+
+std::size_t DijkstraMap::getCost(const Vec2i& position) const
+{
+	return isInBounds(position) ? cell(position).cost : m_maxCost;
+}
+
+Vec2i DijkstraMap::getNextStep(const Vec2i& position) const
+{
+	if (!isReachable(position))
+		return position;
+
+	return cell(position).next;
+}
+
+bool DijkstraMap::isInBounds(const Vec2i& position) const
+{
+	return position.x >= 0 && position.x < m_width && position.y >= 0 && position.y < m_height;
+}
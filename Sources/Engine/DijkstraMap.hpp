@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Vector2.hpp"
+
+#include <functional>
+#include <queue>
+
+// Distance field (flow field) from a single goal to every reachable cell.
+// Computed once per goal, then any number of seekers can read their
+// next step toward the goal in constant time.
+class DijkstraMap
+{
+public:
+	using PassableFunction = std::function<bool(Vec2i)>;
+
+public:
+	DijkstraMap(int width, int height, PassableFunction isPassable);
+
+	void setMaxCost(std::size_t maxCost); // Max search depth
+
+	void compute(const Vec2i& goal);
+	void invalidate();
+
+	bool isValid() const;
+	const Vec2i& getGoal() const;
+
+	bool isReachable(const Vec2i& position) const;
+	std::size_t getCost(const Vec2i& position) const;
+
+	// Returns the position itself if the goal is unreachable from there
+	Vec2i getNextStep(const Vec2i& position) const;
+
+private:
+	struct OpenNode
+	{
+		Vec2i position;
+		std::size_t cost;
+
+		bool operator<(const OpenNode& b) const
+		{
+			return cost > b.cost;
+		}
+	};
+
+	struct Cell
+	{
+		Vec2i next;
+		std::size_t cost;
+	};
+
+	Cell& cell(const Vec2i& position);
+	const Cell& cell(const Vec2i& position) const;
+
+	bool isInBounds(const Vec2i& position) const;
+
+private:
+	int m_width;
+	int m_height;
+	std::size_t m_maxCost;
+	std::vector<Cell> m_cells;
+	std::priority_queue<OpenNode, std::vector<OpenNode>> m_openSet;
+	PassableFunction m_isPassable;
+	Vec2i m_goal;
+	bool m_valid = false;
+};
+
+inline DijkstraMap::Cell& DijkstraMap::cell(const Vec2i& position)
+{
+	return m_cells[position.x + position.y * m_width];
+}
+
+inline const DijkstraMap::Cell& DijkstraMap::cell(const Vec2i& position) const
+{
+	return m_cells[position.x + position.y * m_width];
+}
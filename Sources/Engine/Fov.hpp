@@ -3,26 +3,50 @@
 #pragma once
 
 #include "Vector2.hpp"
+#include "BitGrid.hpp"
 #include "Serializable.hpp"
 
+#include <algorithm> // min, max, upper_bound, copy, copy_backward
+#include <cassert>
 #include <functional>
 #include <vector>
 
 // Field of view
-class Fov : public Serializable
+// The predicate is a template parameter so it can be inlined into the octant loop.
+template <typename BlocksViewFn>
+class BasicFov : public Serializable
 {
 public:
-	using BlocksViewFunction = std::function<bool(Vec2i)>;
+	using BlocksViewFunction = BlocksViewFn;
 
 public:
-	Fov(int width, int height, BlocksViewFunction blocksView);
+	BasicFov(int width, int height, BlocksViewFunction blocksView);
+
+	void setBlocksView(BlocksViewFunction blocksView);
 
 	void clear();
 	void compute(const Vec2i& position, int range);
+	void restore(const BitGrid& visible); // Result of an earlier compute() on the same map
 
 	bool isVisible(const Vec2i& position) const;
 	bool isExplored(const Vec2i& position) const;
 
+	const BitGrid& getVisible() const;
+	const BitGrid& getExplored() const;
+
+	// Calls function(Vec2i) for every visible cell, a word of cells at a time
+	template <typename Function>
+	void forEachVisible(Function function) const;
+
+	// Calls function(Vec2i) for every cell seen from position, some of them twice.
+	// Neither the visible nor the explored grid is touched, see FovBatch.
+	template <typename Function>
+	void forEachSeen(const Vec2i& position, int range, Function function);
+
+	// Swap the explored grid with the level's one, nothing is copied
+	void save(BitGrid& explored);
+	void load(BitGrid& explored);
+
 	void save(std::vector<bool>& explored);
 	void load(std::vector<bool>& explored);
 
@@ -37,19 +61,323 @@ private:
 		bool contains(const Shadow& projection) const;
 	};
 
-	Shadow getProjection(int col, int row);
-	bool isInShadow(const Shadow& projection) const;
+	void reserve(int range);
+
+	const Shadow& getProjection(int col, int row) const;
+	bool isInShadow(const Shadow& projection);
 	bool addShadow(const Shadow& shadow);
 
 	bool isInBounds(const Vec2i& position) const;
-	void setVisible(const Vec2i& position, bool flag);
-	void refreshOctant(int octant, const Vec2i& start, int range);
+	void setVisible(const Vec2i& position);
+	template <typename Function>
+	void refreshOctant(int octant, const Vec2i& start, int range, Function& function);
 
 private:
 	int m_width;
 	int m_height;
-	std::vector<bool> m_visible;
-	std::vector<bool> m_explored;
+	BitGrid m_visible;
+	BitGrid m_explored;
+	// Projection of every (row, col) cell of an octant up to m_maxRange, row by row
+	std::vector<Shadow> m_projections;
+	// Shadow line, sorted and disjoint, its capacity is fixed by the range
 	std::vector<Shadow> m_shadows;
+	std::size_t m_numShadows = 0;
+	std::size_t m_cursor = 0; // Candidate shadow for the current row
+	int m_maxRange = -1;
 	BlocksViewFunction m_blocksView;
 };
+
+// Type-erased version, used when the predicate is only known at runtime
+using Fov = BasicFov<std::function<bool(Vec2i)>>;
+
+extern template class BasicFov<std::function<bool(Vec2i)>>;
+
+template <typename BlocksViewFn>
+BasicFov<BlocksViewFn>::BasicFov(int width, int height, BlocksViewFunction blocksView)
+	: m_width(width)
+	, m_height(height)
+	, m_visible(width, height, false)
+	, m_explored(width, height, false)
+	, m_blocksView(std::move(blocksView))
+{
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::setBlocksView(BlocksViewFunction blocksView)
+{
+	m_blocksView = std::move(blocksView);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::clear()
+{
+	m_visible.fill(false);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::compute(const Vec2i& position, int range)
+{
+	if (range >= 0)
+	{
+		forEachSeen(position, range, [this] (const Vec2i& pos) { setVisible(pos); });
+
+		// Nothing outside the rows in range became visible
+		m_explored.merge(m_visible, std::max(position.y - range, 0), std::min(position.y + range, m_height - 1));
+	}
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::restore(const BitGrid& visible)
+{
+	m_visible = visible;
+	m_explored |= m_visible;
+}
+
+template <typename BlocksViewFn>
+bool BasicFov<BlocksViewFn>::isVisible(const Vec2i& position) const
+{
+	return m_visible.test(position);
+}
+
+template <typename BlocksViewFn>
+bool BasicFov<BlocksViewFn>::isExplored(const Vec2i& position) const
+{
+	return m_explored.test(position);
+}
+
+template <typename BlocksViewFn>
+const BitGrid& BasicFov<BlocksViewFn>::getVisible() const
+{
+	return m_visible;
+}
+
+template <typename BlocksViewFn>
+const BitGrid& BasicFov<BlocksViewFn>::getExplored() const
+{
+	return m_explored;
+}
+
+template <typename BlocksViewFn>
+template <typename Function>
+void BasicFov<BlocksViewFn>::forEachVisible(Function function) const
+{
+	m_visible.forEach(function);
+}
+
+template <typename BlocksViewFn>
+template <typename Function>
+void BasicFov<BlocksViewFn>::forEachSeen(const Vec2i& position, int range, Function function)
+{
+	if (range < 0)
+		return;
+
+	reserve(range);
+	function(position);
+
+	for (int octant = 0; octant < 8; ++octant)
+		refreshOctant(octant, position, range, function);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::save(BitGrid& explored)
+{
+	explored.swap(m_explored);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::load(BitGrid& explored)
+{
+	m_explored.swap(explored);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::save(std::vector<bool>& explored)
+{
+	explored.resize(m_explored.getSize());
+
+	for (std::size_t i = 0; i < explored.size(); ++i)
+		explored[i] = m_explored.test(i);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::load(std::vector<bool>& explored)
+{
+	const std::size_t size = std::min(explored.size(), m_explored.getSize());
+
+	for (std::size_t i = 0; i < size; ++i)
+		m_explored.set(i, explored[i]);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::save(std::ostream& os)
+{
+	serialize(os, m_explored);
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::load(std::istream& is)
+{
+	deserialize(is, m_explored);
+}
+
+template <typename BlocksViewFn>
+bool BasicFov<BlocksViewFn>::Shadow::contains(const Shadow& projection) const
+{
+	return start <= projection.start && end >= projection.end;
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::reserve(int range)
+{
+	if (range <= m_maxRange)
+		return;
+
+	m_maxRange = range;
+	m_projections.clear();
+
+	for (int row = 0; row <= range; ++row)
+	{
+		for (int col = 0; col <= row; ++col)
+		{
+			const float topLeft = static_cast<float>(col) / (row + 2);
+			const float bottomRight = static_cast<float>(col + 1) / (row + 1);
+
+			m_projections.push_back({ topLeft, bottomRight });
+		}
+	}
+
+	// A shadow is at least 1 / (range + 1) wide and shadows don't overlap
+	m_shadows.resize(range + 2);
+}
+
+template <typename BlocksViewFn>
+const typename BasicFov<BlocksViewFn>::Shadow& BasicFov<BlocksViewFn>::getProjection(int col, int row) const
+{
+	return m_projections[row * (row + 1) / 2 + col];
+}
+
+template <typename BlocksViewFn>
+bool BasicFov<BlocksViewFn>::isInShadow(const Shadow& projection)
+{
+	// Projections move right along a row, so does the only shadow that can contain them
+	while (m_cursor + 1 < m_numShadows && m_shadows[m_cursor + 1].start <= projection.start)
+		++m_cursor;
+
+	return m_cursor < m_numShadows && m_shadows[m_cursor].contains(projection);
+}
+
+template <typename BlocksViewFn>
+bool BasicFov<BlocksViewFn>::addShadow(const Shadow& shadow)
+{
+	Shadow* const first = m_shadows.data();
+	Shadow* const last = first + m_numShadows;
+
+	const std::size_t index = std::upper_bound(first, last, shadow.start,
+		[] (float start, const Shadow& s) { return start < s.start; }) - first;
+
+	const bool overlapsPrev = ((index > 0) && (m_shadows[index - 1].end > shadow.start));
+	const bool overlapsNext = ((index < m_numShadows) && (m_shadows[index].start < shadow.end));
+
+	if (overlapsNext)
+	{
+		if (overlapsPrev)
+		{
+			m_shadows[index - 1].end = std::max(m_shadows[index - 1].end, m_shadows[index].end);
+			std::copy(first + index + 1, last, first + index);
+			--m_numShadows;
+		}
+
+		else
+			m_shadows[index].start = std::min(m_shadows[index].start, shadow.start);
+	}
+
+	else
+	{
+		if (overlapsPrev)
+			m_shadows[index - 1].end = std::max(m_shadows[index - 1].end, shadow.end);
+		else
+		{
+			assert(m_numShadows < m_shadows.size());
+			std::copy_backward(first + index, last, last + 1);
+			m_shadows[index] = shadow;
+			++m_numShadows;
+		}
+	}
+
+	// Later projections of the row start at or after this shadow
+	m_cursor = index > 0 ? index - 1 : 0;
+
+	return (m_numShadows == 1) && (m_shadows[0].start == 0.f) && (m_shadows[0].end == 1.f);
+}
+
+template <typename BlocksViewFn>
+bool BasicFov<BlocksViewFn>::isInBounds(const Vec2i& position) const
+{
+	return position.x >= 0 && position.x < m_width && position.y >= 0 && position.y < m_height;
+}
+
+template <typename BlocksViewFn>
+void BasicFov<BlocksViewFn>::setVisible(const Vec2i& position)
+{
+	// Explored cells are merged a word at a time at the end of compute()
+	m_visible.set(position, true);
+}
+
+template <typename BlocksViewFn>
+template <typename Function>
+void BasicFov<BlocksViewFn>::refreshOctant(int octant, const Vec2i& start, int range, Function& function)
+{
+	Vec2i rowInc;
+	Vec2i colInc;
+
+	switch (octant)
+	{
+	case 0: rowInc = {  0, -1 }; colInc = {  1,  0 }; break;
+	case 1: rowInc = {  1,  0 }; colInc = {  0, -1 }; break;
+	case 2: rowInc = {  1,  0 }; colInc = {  0,  1 }; break;
+	case 3: rowInc = {  0,  1 }; colInc = {  1,  0 }; break;
+	case 4: rowInc = {  0,  1 }; colInc = { -1,  0 }; break;
+	case 5: rowInc = { -1,  0 }; colInc = {  0,  1 }; break;
+	case 6: rowInc = { -1,  0 }; colInc = {  0, -1 }; break;
+	case 7: rowInc = {  0, -1 }; colInc = { -1,  0 }; break;
+	}
+
+	m_numShadows = 0;
+
+	for (int row = 1; row <= range; ++row)
+	{
+		Vec2i pos = start + (rowInc * row);
+
+		if (!isInBounds(pos))
+			break;
+
+		m_cursor = 0;
+
+		for (int col = 0; col <= row; ++col)
+		{
+			// Circular field of view
+			if ((pos - start).lengthSquared() > range * range)
+				break;
+
+			const Shadow& projection = getProjection(col, row);
+
+			if (!isInShadow(projection))
+			{
+				function(pos);
+
+				if (m_blocksView(pos))
+				{
+					const bool fullShadow = addShadow(projection);
+
+					if (fullShadow)
+						return;
+				}
+			}
+
+			pos += colInc;
+
+			if (!isInBounds(pos))
+				break;
+		}
+	}
+}
@@ -0,0 +1,169 @@
+#include "FovBatch.hpp"
+
+#include <algorithm> // max
+
+FovBatch::FovBatch(int numThreads)
+{
+#ifndef __EMSCRIPTEN__
+	if (numThreads <= 0)
+		numThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	m_fovs.resize(numThreads);
+
+	for (int i = 0; i < numThreads - 1; ++i)
+		m_threads.emplace_back(&FovBatch::workerLoop, this, i);
+#else
+	// No threads in the browser
+	(void)numThreads;
+	m_fovs.resize(1);
+#endif
+}
+
+FovBatch::~FovBatch()
+{
+#ifndef __EMSCRIPTEN__
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+
+	m_wake.notify_all();
+
+	for (auto& thread : m_threads)
+		thread.join();
+#endif
+}
+
+void FovBatch::compute(const BitGrid& opaque, const std::vector<Viewer>& viewers)
+{
+	m_viewers = &viewers;
+
+	// Every viewer starts on a fresh word, so threads never write to the same one
+	std::size_t numWords = 0;
+	m_results.resize(viewers.size());
+
+	for (std::size_t i = 0; i < viewers.size(); ++i)
+	{
+		const Viewer& viewer = viewers[i];
+		const int size = viewer.range >= 0 ? viewer.range * 2 + 1 : 0;
+
+		m_results[i] = { viewer.position - Vec2i(viewer.range, viewer.range), size, numWords };
+		numWords += (static_cast<std::size_t>(size * size) + BitGrid::WordBits - 1) / BitGrid::WordBits;
+	}
+
+	m_words.assign(numWords, 0);
+
+	for (auto& fov : m_fovs)
+	{
+		if (!fov || fov->getVisible().getWidth() != opaque.getWidth() || fov->getVisible().getHeight() != opaque.getHeight())
+			fov = std::make_unique<ViewerFov>(opaque.getWidth(), opaque.getHeight(), BitGrid::Reader{ &opaque });
+		else
+			fov->setBlocksView({ &opaque });
+	}
+
+	m_nextViewer = 0;
+
+#ifndef __EMSCRIPTEN__
+	if (!m_threads.empty() && viewers.size() >= m_minParallelViewers)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_batch;
+			m_numBusy = m_threads.size();
+		}
+
+		m_wake.notify_all();
+		run(*m_fovs.back());
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] () { return m_numBusy == 0; });
+		return;
+	}
+#endif
+
+	run(*m_fovs.back());
+}
+
+std::size_t FovBatch::getNumViewers() const
+{
+	return m_results.size();
+}
+
+std::size_t FovBatch::getNumThreads() const
+{
+	return m_fovs.size();
+}
+
+bool FovBatch::isVisible(std::size_t viewer, const Vec2i& position) const
+{
+	const Result& result = m_results[viewer];
+	const Vec2i local = position - result.origin;
+
+	if (local.x < 0 || local.x >= result.size || local.y < 0 || local.y >= result.size)
+		return false;
+
+	const std::size_t bit = local.x + local.y * result.size;
+
+	return (m_words[result.offset + bit / BitGrid::WordBits] >> (bit % BitGrid::WordBits)) & 1;
+}
+
+std::size_t FovBatch::getNumVisible(std::size_t viewer) const
+{
+	const Result& result = m_results[viewer];
+	const std::size_t numWords = (static_cast<std::size_t>(result.size * result.size) + BitGrid::WordBits - 1) / BitGrid::WordBits;
+
+	std::size_t count = 0;
+
+	for (std::size_t i = 0; i < numWords; ++i)
+		for (BitGrid::Word word = m_words[result.offset + i]; word != 0; word &= word - 1)
+			++count;
+
+	return count;
+}
+
+void FovBatch::run(ViewerFov& fov)
+{
+	// Viewers are handed out one at a time, cheap ones don't hold a thread back
+	for (std::size_t i = m_nextViewer++; i < m_results.size(); i = m_nextViewer++)
+		computeViewer(fov, i);
+}
+
+void FovBatch::computeViewer(ViewerFov& fov, std::size_t i)
+{
+	const Viewer& viewer = (*m_viewers)[i];
+	const Result& result = m_results[i];
+	BitGrid::Word* const words = m_words.data() + result.offset;
+
+	fov.forEachSeen(viewer.position, viewer.range, [&] (const Vec2i& pos)
+	{
+		const std::size_t bit = (pos.x - result.origin.x) + (pos.y - result.origin.y) * result.size;
+		words[bit / BitGrid::WordBits] |= BitGrid::Word(1) << (bit % BitGrid::WordBits);
+	});
+}
+
+#ifndef __EMSCRIPTEN__
+void FovBatch::workerLoop(std::size_t index)
+{
+	unsigned int batch = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&] () { return m_quit || m_batch != batch; });
+
+			if (m_quit)
+				return;
+
+			batch = m_batch;
+		}
+
+		run(*m_fovs[index]);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (--m_numBusy == 0)
+			m_done.notify_one();
+	}
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Fov.hpp"
+#include "BitGrid.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Field of view of many viewers at once, all reading the same opacity grid.
+// Viewers are independent so they are spread over a pool of worker threads,
+// each viewer only keeps the bits of the square it can see.
+class FovBatch
+{
+public:
+	struct Viewer
+	{
+		Vec2i position;
+		int range;
+	};
+
+public:
+	explicit FovBatch(int numThreads = 0); // Counts the calling thread, 0 uses every core
+	~FovBatch();
+
+	FovBatch(const FovBatch&) = delete;
+	FovBatch& operator=(const FovBatch&) = delete;
+
+	void compute(const BitGrid& opaque, const std::vector<Viewer>& viewers);
+
+	std::size_t getNumViewers() const;
+	std::size_t getNumThreads() const;
+
+	bool isVisible(std::size_t viewer, const Vec2i& position) const;
+	std::size_t getNumVisible(std::size_t viewer) const;
+
+private:
+	using ViewerFov = BasicFov<BitGrid::Reader>;
+
+	// Square of size * size cells around a viewer, its bits start at m_words[offset]
+	struct Result
+	{
+		Vec2i origin;
+		int size;
+		std::size_t offset;
+	};
+
+	void run(ViewerFov& fov);
+	void computeViewer(ViewerFov& fov, std::size_t i);
+
+#ifndef __EMSCRIPTEN__
+	void workerLoop(std::size_t index);
+#endif
+
+private:
+	// Below this, waking the workers costs more than it saves
+	static constexpr std::size_t m_minParallelViewers = 16;
+
+	const std::vector<Viewer>* m_viewers = nullptr;
+	std::vector<Result> m_results;
+	std::vector<BitGrid::Word> m_words;
+	std::vector<std::unique_ptr<ViewerFov>> m_fovs; // One per thread, the calling thread uses the last one
+	std::atomic<std::size_t> m_nextViewer{ 0 };
+
+#ifndef __EMSCRIPTEN__
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	unsigned int m_batch = 0;
+	std::size_t m_numBusy = 0;
+	bool m_quit = false;
+#endif
+};
@@ -0,0 +1,206 @@
+#include "GlyphCache.hpp"
+#include "Atlas.hpp"
+
+// The 32-bit glyph functions came with SDL_ttf 2.0.18, older ports only reach the BMP
+#ifdef SDL_TTF_VERSION_ATLEAST
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+#define TTF_HAS_GLYPH32
+#endif
+#endif
+
+namespace
+{
+	bool isGlyphProvided(TTF_Font* font, char32_t ch)
+	{
+#ifdef TTF_HAS_GLYPH32
+		return TTF_GlyphIsProvided32(font, ch);
+#else
+		return ch <= 0xFFFF && TTF_GlyphIsProvided(font, static_cast<Uint16>(ch));
+#endif
+	}
+
+	SDL_Surface* renderGlyph(TTF_Font* font, char32_t ch, SDL_Color color)
+	{
+#ifdef TTF_HAS_GLYPH32
+		return TTF_RenderGlyph32_Blended(font, ch, color);
+#else
+		return TTF_RenderGlyph_Blended(font, static_cast<Uint16>(ch), color);
+#endif
+	}
+}
+
+GlyphCache::GlyphCache(Atlas& atlas, std::size_t capacity)
+	: m_atlas(atlas)
+	, m_capacity(capacity)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+	if (m_font)
+		TTF_CloseFont(m_font);
+
+	if (m_quitTtf)
+		TTF_Quit();
+}
+
+void GlyphCache::setFont(const std::string& path, int size)
+{
+	m_fontPath = path;
+	m_fontSize = size;
+}
+
+void GlyphCache::setTileSize(int width, int height)
+{
+	m_tileWidth = width;
+	m_tileHeight = height;
+}
+
+int GlyphCache::acquire(char32_t ch)
+{
+	if (const auto found = m_tilesByChar.find(ch); found != m_tilesByChar.end())
+	{
+		Tile& tile = m_tiles[found->second];
+
+		if (tile.numUsers++ == 0)
+			unlink(found->second);
+
+		return tile.id;
+	}
+
+	// Nothing can be evicted, the glyph isn't even rasterized
+	if (m_tiles.size() >= m_capacity && m_lruHead < 0)
+		return -1;
+
+	SDL_Surface* surface = rasterize(ch);
+	if (!surface)
+		return -1;
+
+	int index;
+
+	if (m_tiles.size() < m_capacity)
+	{
+		index = m_tiles.size();
+		Tile& tile = m_tiles.emplace_back();
+		tile.id = m_atlas.addSurface(surface);
+
+		if (static_cast<std::size_t>(tile.id) >= m_tilesById.size())
+			m_tilesById.resize(tile.id + 1, -1);
+
+		m_tilesById[tile.id] = index;
+	}
+
+	else
+	{
+		// The least recently used glyph gives up its place in the atlas
+		index = m_lruHead;
+		unlink(index);
+		m_tilesByChar.erase(m_tiles[index].ch);
+		m_atlas.updateSurface(m_tiles[index].id, surface);
+		++m_numEvicted;
+	}
+
+	Tile& tile = m_tiles[index];
+	tile.ch = ch;
+	tile.numUsers = 1;
+	tile.prev = tile.next = -1;
+	m_tilesByChar.emplace(ch, index);
+
+	return tile.id;
+}
+
+void GlyphCache::release(int id)
+{
+	if (id < 0 || static_cast<std::size_t>(id) >= m_tilesById.size() || m_tilesById[id] < 0)
+		return;
+
+	const int index = m_tilesById[id];
+
+	if (--m_tiles[index].numUsers == 0)
+		pushBack(index);
+}
+
+std::size_t GlyphCache::getNumTiles() const
+{
+	return m_tiles.size();
+}
+
+std::size_t GlyphCache::getNumRasterized() const
+{
+	return m_numRasterized;
+}
+
+std::size_t GlyphCache::getNumEvicted() const
+{
+	return m_numEvicted;
+}
+
+SDL_Surface* GlyphCache::rasterize(char32_t ch)
+{
+	if (!m_font && !m_fontFailed && !m_fontPath.empty())
+	{
+		if (!TTF_WasInit())
+			m_quitTtf = TTF_Init() == 0;
+
+		m_font = TTF_OpenFont(m_fontPath.c_str(), m_fontSize);
+		m_fontFailed = !m_font;
+	}
+
+	// Not provided, the console draws '?' instead
+	if (!m_font || !isGlyphProvided(m_font, ch))
+		return nullptr;
+
+	SDL_Surface* glyph = renderGlyph(m_font, ch, SDL_Color{ 0xFF, 0xFF, 0xFF, 0xFF });
+	if (!glyph)
+		return nullptr;
+
+	// Every tile has the same size so an evicted one can be overwritten in place.
+	// Wide glyphs are centered and clipped to the cell.
+	SDL_Surface* tile = SDL_CreateRGBSurface(0, m_tileWidth, m_tileHeight, 32,
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff
+#else
+		0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000
+#endif
+	);
+
+	SDL_Rect dstRect = { (m_tileWidth - glyph->w) / 2, 0, glyph->w, glyph->h };
+	SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+	SDL_BlitSurface(glyph, nullptr, tile, &dstRect);
+	SDL_FreeSurface(glyph);
+
+	++m_numRasterized;
+
+	return tile;
+}
+
+void GlyphCache::unlink(int index)
+{
+	Tile& tile = m_tiles[index];
+
+	if (tile.prev >= 0)
+		m_tiles[tile.prev].next = tile.next;
+	else
+		m_lruHead = tile.next;
+
+	if (tile.next >= 0)
+		m_tiles[tile.next].prev = tile.prev;
+	else
+		m_lruTail = tile.prev;
+
+	tile.prev = tile.next = -1;
+}
+
+void GlyphCache::pushBack(int index)
+{
+	Tile& tile = m_tiles[index];
+	tile.prev = m_lruTail;
+	tile.next = -1;
+
+	if (m_lruTail >= 0)
+		m_tiles[m_lruTail].next = index;
+	else
+		m_lruHead = index;
+
+	m_lruTail = index;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SDL2/SDL_ttf.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Atlas;
+
+// Glyphs outside the baked set of Console, rasterized into the atlas on first use.
+// At most `capacity` tiles are ever added, a glyph no cell shows any more keeps its
+// tile until it is the least recently used one and another glyph needs the space.
+class GlyphCache
+{
+public:
+	GlyphCache(Atlas& atlas, std::size_t capacity);
+	~GlyphCache();
+
+	GlyphCache(const GlyphCache&) = delete;
+	GlyphCache& operator=(const GlyphCache&) = delete;
+
+	// The font is only opened on the first miss, without one every glyph is a miss
+	void setFont(const std::string& path, int size);
+	void setTileSize(int width, int height);
+
+	// Sprite id of the glyph, -1 when the font lacks it or every tile is on screen.
+	// Each acquire() is paired with a release() of the returned id.
+	int acquire(char32_t ch);
+	void release(int id); // Ids that aren't glyphs of the cache are ignored
+
+	std::size_t getNumTiles() const;
+	std::size_t getNumRasterized() const;
+	std::size_t getNumEvicted() const;
+
+private:
+	struct Tile
+	{
+		char32_t ch;
+		int id;
+		int numUsers; // Cells showing the glyph
+		int prev;     // Unused tiles, least recently used first
+		int next;
+	};
+
+	SDL_Surface* rasterize(char32_t ch);
+	void unlink(int tile);
+	void pushBack(int tile);
+
+private:
+	Atlas& m_atlas;
+	std::size_t m_capacity;
+	std::string m_fontPath;
+	int m_fontSize = 0;
+	TTF_Font* m_font = nullptr;
+	bool m_fontFailed = false;
+	bool m_quitTtf = false; // TTF was initialized here
+	int m_tileWidth = 0;
+	int m_tileHeight = 0;
+	std::vector<Tile> m_tiles;
+	std::unordered_map<char32_t, int> m_tilesByChar;
+	std::vector<int> m_tilesById; // -1 for ids of other surfaces
+	int m_lruHead = -1;
+	int m_lruTail = -1;
+	std::size_t m_numRasterized = 0;
+	std::size_t m_numEvicted = 0;
+};
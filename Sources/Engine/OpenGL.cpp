@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include <cstdint>
+#include <cstring> // memcpy
 #include <iostream>
 #include <vector>
 
@@ -119,6 +121,32 @@ void Texture::copyFromSurface(SDL_Surface* surface)
 				   surface->pixels);
 }
 
+void Texture::copyRegionFromSurface(SDL_Surface* surface, int x, int y, int width, int height)
+{
+	const int bytesPerPixel = surface->format->BytesPerPixel;
+	const GLenum format = bytesPerPixel == 1 ? GL_ALPHA : bytesPerPixel == 3 ? GL_RGB : GL_RGBA;
+	const auto* pixels = static_cast<const std::uint8_t*>(surface->pixels) + y * surface->pitch + x * bytesPerPixel;
+
+	glBindTexture(GL_TEXTURE_2D, id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// GL ES 2 has no GL_UNPACK_ROW_LENGTH, rows narrower than the surface are copied together first
+	if (width * bytesPerPixel == surface->pitch)
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, GL_UNSIGNED_BYTE, pixels);
+	else
+	{
+		std::vector<std::uint8_t> region(width * height * bytesPerPixel);
+
+		for (int row = 0; row < height; ++row)
+			std::memcpy(&region[row * width * bytesPerPixel], pixels + row * surface->pitch, width * bytesPerPixel);
+
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, GL_UNSIGNED_BYTE, region.data());
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GL_Errors("glTexSubImage2D");
+}
+
 VertexBuffer::VertexBuffer()
 {
 	glGenBuffers(1, &id);
@@ -43,6 +43,7 @@ struct Texture : NonCopyable
 
 	void copyFromPixels(int width, int height, GLenum format, void* pixels);
 	void copyFromSurface(SDL_Surface* surface);
+	void copyRegionFromSurface(SDL_Surface* surface, int x, int y, int width, int height); // Same size as the last copyFromSurface()
 };
 
 struct VertexBuffer : NonCopyable
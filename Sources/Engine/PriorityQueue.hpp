@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm> // push_heap, pop_heap
+#include <cassert>
+#include <vector>
+
+// Min-priority queues keyed on non-negative integers.
+// Both share the same interface so the path finders can switch between them.
+
+// General binary heap, O(log n) push and pop
+template <typename T>
+class BinaryHeap
+{
+public:
+	bool isEmpty() const;
+	void clear();
+
+	void push(std::size_t key, const T& value);
+	T pop();
+
+private:
+	struct Node
+	{
+		std::size_t key;
+		T value;
+
+		bool operator<(const Node& b) const
+		{
+			return key > b.key;
+		}
+	};
+
+	std::vector<Node> m_nodes;
+};
+
+// Bucket queue (Dial's algorithm), O(1) push and amortized O(1) pop.
+// Meant for small keys like path costs: one bucket per key value.
+// Popping is fastest when keys are monotone, but smaller keys are allowed.
+template <typename T>
+class BucketQueue
+{
+public:
+	bool isEmpty() const;
+	void clear();
+
+	void push(std::size_t key, const T& value);
+	T pop();
+
+private:
+	std::vector<std::vector<T>> m_buckets;
+	std::size_t m_size = 0;
+	std::size_t m_minKey = 0; // Every bucket below this one is empty
+	std::size_t m_maxKey = 0; // Every bucket above this one is empty
+};
+
+template <typename T>
+bool BinaryHeap<T>::isEmpty() const
+{
+	return m_nodes.empty();
+}
+
+template <typename T>
+void BinaryHeap<T>::clear()
+{
+	m_nodes.clear();
+}
+
+template <typename T>
+void BinaryHeap<T>::push(std::size_t key, const T& value)
+{
+	m_nodes.push_back({ key, value });
+	std::push_heap(m_nodes.begin(), m_nodes.end());
+}
+
+template <typename T>
+T BinaryHeap<T>::pop()
+{
+	assert(!isEmpty());
+
+	std::pop_heap(m_nodes.begin(), m_nodes.end());
+	const T value = m_nodes.back().value;
+	m_nodes.pop_back();
+
+	return value;
+}
+
+template <typename T>
+bool BucketQueue<T>::isEmpty() const
+{
+	return m_size == 0;
+}
+
+template <typename T>
+void BucketQueue<T>::clear()
+{
+	// Keep the buckets and their capacity for the next use
+	if (m_size > 0)
+	{
+		for (std::size_t key = m_minKey; key <= m_maxKey; ++key)
+			m_buckets[key].clear();
+	}
+
+	m_size = 0;
+	m_minKey = 0;
+	m_maxKey = 0;
+}
+
+template <typename T>
+void BucketQueue<T>::push(std::size_t key, const T& value)
+{
+	if (key >= m_buckets.size())
+		m_buckets.resize(key + 1);
+
+	if (m_size == 0)
+	{
+		m_minKey = key;
+		m_maxKey = key;
+	}
+
+	else
+	{
+		m_minKey = std::min(m_minKey, key);
+		m_maxKey = std::max(m_maxKey, key);
+	}
+
+	m_buckets[key].push_back(value);
+	++m_size;
+}
+
+template <typename T>
+T BucketQueue<T>::pop()
+{
+	assert(!isEmpty());
+
+	while (m_buckets[m_minKey].empty())
+		++m_minKey;
+
+	auto& bucket = m_buckets[m_minKey];
+	const T value = bucket.back();
+	bucket.pop_back();
+	--m_size;
+
+	return value;
+}
@@ -1,30 +1,44 @@
 #include "Renderer.hpp"
 #include "OpenGL.hpp"
+#include "SpriteBatch.hpp"
 
 #include <SDL2/SDL.h>
 
-#include <cmath> // floor
+#include <algorithm> // max
+#include <cmath> // floor, lround
 
-struct Attributes
+static_assert(sizeof(SpriteBatch::Vertex) == 12, "Vertices are read with a 12 byte stride");
+
+// One per sprite when instancing, the quad corners come from a static buffer
+struct Instance
 {
-	GLfloat corner[2];   // Location of corner relative to center, in world coords
-	GLfloat position[2]; // Location of center in world coordinates
-	GLfloat texcoord[2]; // Texture s,t of this corner
-	GLfloat color[4];
+	GLshort rect[4];      // Top left corner and size, in world coords
+	GLushort texcoord[4]; // Texture s,t of the top left and bottom right corners, normalized
+	GLubyte color[4];
 };
 
 struct RendererImpl
 {
 	Atlas& atlas;
 
-	std::vector<Attributes> vertices;
-	std::vector<GLuint> indices;
+	// GL ES 2 / WebGL 1 has no instancing, every sprite is expanded to a quad
+	const bool instanced;
+
+	SpriteBatch batch;
+	std::vector<Instance> instances;
+
+	// The index pattern never changes, it only grows with the number of sprites
+	std::vector<std::uint32_t> indices;
+	std::size_t indexCapacity = 0;
+	std::size_t vertexCapacity = 0;
+	std::size_t numUploadedBytes = 0;
 
 	ShaderProgram shader;
 	Texture texture;
 
 	VertexBuffer vboAttributes;
 	VertexBuffer vboIndex;
+	VertexBuffer vboQuad;
 
 	// Uniforms
 	GLint uTexture;
@@ -35,8 +49,17 @@ struct RendererImpl
 	GLint aPosition;
 	GLint aTexcoord;
 	GLint aColor;
+	GLint aRect; // Instanced only
 
 	RendererImpl(Atlas& atlas);
+
+	void setInstances(const std::vector<Sprite>& sprites);
+
+	void uploadTexture();
+
+	void uploadVertices();
+	void drawVertices();
+	void drawInstances();
 };
 
 Renderer::Renderer(Atlas& atlas)
@@ -48,12 +71,21 @@ Renderer::~Renderer()
 {
 }
 
+bool Renderer::isInstanced() const
+{
+	return self->instanced;
+}
+
+std::size_t Renderer::getNumUploadedBytes() const
+{
+	return self->numUploadedBytes;
+}
+
 // Shader program for drawing sprites
 namespace
 {
 
 constexpr GLchar vertexShader[] = R"(
-attribute vec2 aCorner;
 attribute vec2 aPosition;
 attribute vec2 aTexcoord;
 attribute vec4 aColor;
@@ -63,13 +95,31 @@ uniform mat4 uProjection;
 
 void main()
 {
-	vec2 worldCoords = aCorner + aPosition;
+	vec2 worldCoords = aPosition;
 	gl_Position = uProjection * vec4(worldCoords, 0.0, 1.0);
 	vTexcoord = aTexcoord;
 	vColor = aColor;
 }
 )";
 
+constexpr GLchar instancedVertexShader[] = R"(
+attribute vec2 aCorner;
+attribute vec4 aRect;
+attribute vec4 aTexcoord;
+attribute vec4 aColor;
+varying vec2 vTexcoord;
+varying vec4 vColor;
+uniform mat4 uProjection;
+
+void main()
+{
+	vec2 worldCoords = aRect.xy + aCorner * aRect.zw;
+	gl_Position = uProjection * vec4(worldCoords, 0.0, 1.0);
+	vTexcoord = mix(aTexcoord.xy, aTexcoord.zw, aCorner);
+	vColor = aColor;
+}
+)";
+
 constexpr GLchar fragmentShader[] = R"(
 uniform sampler2D uTexture;
 varying vec2 vTexcoord;
@@ -81,11 +131,36 @@ void main()
 }
 )";
 
+bool isInstancingSupported()
+{
+#ifdef GL_ES_VERSION_2_0
+	return false;
+#else
+	return GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced;
+#endif
+}
+
+GLshort toShort(float value)
+{
+	return static_cast<GLshort>(std::lround(value));
+}
+
+GLushort toUnorm16(float value)
+{
+	return static_cast<GLushort>(std::lround(value * 65535.f));
+}
+
+GLubyte toUnorm8(float value)
+{
+	return static_cast<GLubyte>(std::lround(value * 255.f));
+}
+
 }
 
 RendererImpl::RendererImpl(Atlas& atlas)
 	: atlas(atlas)
-	, shader(vertexShader, fragmentShader)
+	, instanced(isInstancingSupported())
+	, shader(instanced ? instancedVertexShader : vertexShader, fragmentShader)
 {
 	uTexture    = glGetUniformLocation(shader.id, "uTexture");
 	uProjection = glGetUniformLocation(shader.id, "uProjection");
@@ -93,68 +168,61 @@ RendererImpl::RendererImpl(Atlas& atlas)
 	aCorner     = glGetAttribLocation(shader.id, "aCorner");
 	aPosition   = glGetAttribLocation(shader.id, "aPosition");
 	aColor      = glGetAttribLocation(shader.id, "aColor");
+	aRect       = glGetAttribLocation(shader.id, "aRect");
 
 	texture.copyFromSurface(atlas.getSurface());
+	atlas.markUploaded();
+
+	if (instanced)
+	{
+		// Same corner order as the indices of the other path
+		constexpr GLfloat corners[8] = { 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+
+		glBindBuffer(GL_ARRAY_BUFFER, vboQuad.id);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		GL_Errors("glBufferData");
+	}
 }
 
 void Renderer::clearSprites()
 {
-	self->vertices.clear();
-	self->indices.clear();
+	self->batch.clear();
+	self->instances.clear();
 }
 
 void Renderer::setSprites(const std::vector<Sprite>& sprites)
 {
-	auto& vertices = self->vertices;
-	auto& indices = self->indices;
+	// Packs the glyphs added since the last frame, their locations are needed below
+	self->atlas.getSurface();
 
-	vertices.resize(sprites.size() * 4);
+	if (self->instanced)
+		self->setInstances(sprites);
+	else
+		self->batch.setSprites(sprites, [this] (int id) -> const SpriteLocation& { return self->atlas.getLocation(id); });
+}
+
+void RendererImpl::setInstances(const std::vector<Sprite>& sprites)
+{
+	instances.resize(sprites.size());
 	for (std::size_t i = 0; i < sprites.size(); ++i)
 	{
 		const Sprite& S = sprites[i];
-		const SpriteLocation& loc = self->atlas.getLocation(S.id);
-
-		auto* vertex = &vertices[i * 4];
-
-		vertex[0].corner[0] = loc.x0 * S.scaleX;
-		vertex[0].corner[1] = loc.y0 * S.scaleY;
-		vertex[0].texcoord[0] = loc.s0;
-		vertex[0].texcoord[1] = loc.t0;
-
-		vertex[1].corner[0] = loc.x1 * S.scaleX;
-		vertex[1].corner[1] = loc.y0 * S.scaleY;
-		vertex[1].texcoord[0] = loc.s1;
-		vertex[1].texcoord[1] = loc.t0;
-
-		vertex[2].corner[0] = loc.x0 * S.scaleX;
-		vertex[2].corner[1] = loc.y1 * S.scaleY;
-		vertex[2].texcoord[0] = loc.s0;
-		vertex[2].texcoord[1] = loc.t1;
-
-		vertex[3].corner[0] = loc.x1 * S.scaleX;
-		vertex[3].corner[1] = loc.y1 * S.scaleY;
-		vertex[3].texcoord[0] = loc.s1;
-		vertex[3].texcoord[1] = loc.t1;
-
-		for (int j = 0; j < 4; ++j)
-		{
-			vertex[j].position[0] = S.x - loc.x0 * S.scaleX;
-			vertex[j].position[1] = S.y - loc.y0 * S.scaleY;
-			vertex[j].color[0] = S.r;
-			vertex[j].color[1] = S.g;
-			vertex[j].color[2] = S.b;
-			vertex[j].color[3] = S.a;
-		}
-	}
-
-	constexpr GLuint cornerIndex[6] = { 0, 1, 2, 2, 1, 3 };
-
-	std::size_t i = indices.size();
-	indices.resize(sprites.size() * 6);
-	for (; i < indices.size(); ++i)
-	{
-		const int j = i / 6;
-		indices[i] = j * 4 + cornerIndex[i % 6];
+		const SpriteLocation& loc = atlas.getLocation(S.id);
+
+		Instance& instance = instances[i];
+
+		instance.rect[0] = toShort(S.x);
+		instance.rect[1] = toShort(S.y);
+		instance.rect[2] = toShort((loc.x1 - loc.x0) * S.scaleX);
+		instance.rect[3] = toShort((loc.y1 - loc.y0) * S.scaleY);
+		instance.texcoord[0] = toUnorm16(loc.s0);
+		instance.texcoord[1] = toUnorm16(loc.t0);
+		instance.texcoord[2] = toUnorm16(loc.s1);
+		instance.texcoord[3] = toUnorm16(loc.t1);
+		instance.color[0] = toUnorm8(S.r);
+		instance.color[1] = toUnorm8(S.g);
+		instance.color[2] = toUnorm8(S.b);
+		instance.color[3] = toUnorm8(S.a);
 	}
 }
 
@@ -196,39 +264,145 @@ void Renderer::render(SDL_Window* window)
 	// case). We have to bind register 0 to the texture id:
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, self->texture.id);
+	self->uploadTexture();
 	// and then we have to tell the shader which register (0) to use:
 	glUniform1i(self->uTexture, 0);
 	// It might be ok to hard-code the register number inside the shader.
 
-	// Tell the shader program where to find each of the input variables
-	// ("attributes") in its vertex shader input.
-	glBindBuffer(GL_ARRAY_BUFFER, self->vboAttributes.id);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Attributes) * self->vertices.size(), self->vertices.data(), GL_STREAM_DRAW);
+	self->numUploadedBytes = 0;
+
+	if (self->instanced)
+		self->drawInstances();
+	else
+		self->drawVertices();
+
+	glDisable(GL_BLEND);
+}
+
+void RendererImpl::uploadTexture()
+{
+	SDL_Surface* surface = atlas.getSurface();
+	const Atlas::Region& region = atlas.getChangedRegion();
+
+	// A resized atlas is a new texture, otherwise only the new glyphs are sent
+	if (atlas.isResized())
+		texture.copyFromSurface(surface);
+	else if (!region.isEmpty())
+		texture.copyRegionFromSurface(surface, region.x, region.y, region.w, region.h);
+
+	atlas.markUploaded();
+}
+
+void RendererImpl::uploadVertices()
+{
+	using Vertex = SpriteBatch::Vertex;
+
+	const auto& vertices = batch.getVertices();
+
+	glBindBuffer(GL_ARRAY_BUFFER, vboAttributes.id);
+
+	if (batch.isResized() && vertices.size() > vertexCapacity)
+	{
+		vertexCapacity = vertices.size();
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_DYNAMIC_DRAW);
+		numUploadedBytes += sizeof(Vertex) * vertices.size();
+	}
+
+	else if (batch.isResized())
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * vertices.size(), vertices.data());
+		numUploadedBytes += sizeof(Vertex) * vertices.size();
+	}
+
+	else
+	{
+		for (const auto& range : batch.getChangedRanges())
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, sizeof(Vertex) * range.first, sizeof(Vertex) * range.count, &vertices[range.first]);
+			numUploadedBytes += sizeof(Vertex) * range.count;
+		}
+	}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, self->vboIndex.id);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * self->indices.size(), self->indices.data(), GL_DYNAMIC_DRAW);
+	GL_Errors("glBufferSubData");
+	batch.markUploaded();
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboIndex.id);
+
+	if (batch.getNumSprites() > indexCapacity)
+	{
+		// Grow geometrically so a slowly growing batch doesn't rebuild it every frame
+		indexCapacity = std::max(batch.getNumSprites(), indexCapacity * 2);
+		SpriteBatch::makeIndices(indices, indexCapacity);
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+		numUploadedBytes += sizeof(std::uint32_t) * indices.size();
+		GL_Errors("glBufferData");
+	}
+}
 
-	glVertexAttribPointer(self->aCorner, 2, GL_FLOAT, GL_FALSE, sizeof(Attributes), reinterpret_cast<GLvoid*>(offsetof(Attributes, corner)));
-	glVertexAttribPointer(self->aPosition, 2, GL_FLOAT, GL_FALSE, sizeof(Attributes), reinterpret_cast<GLvoid*>(offsetof(Attributes, position)));
-	glVertexAttribPointer(self->aTexcoord, 2, GL_FLOAT, GL_FALSE, sizeof(Attributes), reinterpret_cast<GLvoid*>(offsetof(Attributes, texcoord)));
-	glVertexAttribPointer(self->aColor, 4, GL_FLOAT, GL_FALSE, sizeof(Attributes), reinterpret_cast<GLvoid*>(offsetof(Attributes, color)));
+void RendererImpl::drawVertices()
+{
+	using Vertex = SpriteBatch::Vertex;
+
+	uploadVertices();
+
+	// Tell the shader program where to find each of the input variables
+	// ("attributes") in its vertex shader input.
+	glBindBuffer(GL_ARRAY_BUFFER, vboAttributes.id);
+	glVertexAttribPointer(aPosition, 2, GL_SHORT, GL_FALSE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, position)));
+	glVertexAttribPointer(aTexcoord, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, texcoord)));
+	glVertexAttribPointer(aColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, color)));
 	GL_Errors("glVertexAttribPointer");
 
 	// Run the shader program. Enable the vertex attribs just while
 	// running this program. Which ones are enabled is global state, and
 	// we don't want to interfere with any other shader programs we want
 	// to run elsewhere.
-	glEnableVertexAttribArray(self->aCorner);
-	glEnableVertexAttribArray(self->aPosition);
-	glEnableVertexAttribArray(self->aTexcoord);
-	glEnableVertexAttribArray(self->aColor);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, self->vboIndex.id);
-	glDrawElements(GL_TRIANGLES, self->indices.size(), GL_UNSIGNED_INT, 0);
-	glDisableVertexAttribArray(self->aColor);
-	glDisableVertexAttribArray(self->aTexcoord);
-	glDisableVertexAttribArray(self->aPosition);
-	glDisableVertexAttribArray(self->aCorner);
+	glEnableVertexAttribArray(aPosition);
+	glEnableVertexAttribArray(aTexcoord);
+	glEnableVertexAttribArray(aColor);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboIndex.id);
+	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.getNumSprites() * 6), GL_UNSIGNED_INT, 0);
+	glDisableVertexAttribArray(aColor);
+	glDisableVertexAttribArray(aTexcoord);
+	glDisableVertexAttribArray(aPosition);
 	GL_Errors("glDrawElements");
+}
 
-	glDisable(GL_BLEND);
+void RendererImpl::drawInstances()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, vboQuad.id);
+	glVertexAttribPointer(aCorner, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vboAttributes.id);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Instance) * instances.size(), instances.data(), GL_STREAM_DRAW);
+	numUploadedBytes += sizeof(Instance) * instances.size();
+
+	glVertexAttribPointer(aRect, 4, GL_SHORT, GL_FALSE, sizeof(Instance), reinterpret_cast<GLvoid*>(offsetof(Instance, rect)));
+	glVertexAttribPointer(aTexcoord, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Instance), reinterpret_cast<GLvoid*>(offsetof(Instance, texcoord)));
+	glVertexAttribPointer(aColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), reinterpret_cast<GLvoid*>(offsetof(Instance, color)));
+	GL_Errors("glVertexAttribPointer");
+
+#ifndef GL_ES_VERSION_2_0
+	// Every attribute but the corner advances once per sprite
+	glVertexAttribDivisorARB(aRect, 1);
+	glVertexAttribDivisorARB(aTexcoord, 1);
+	glVertexAttribDivisorARB(aColor, 1);
+
+	glEnableVertexAttribArray(aCorner);
+	glEnableVertexAttribArray(aRect);
+	glEnableVertexAttribArray(aTexcoord);
+	glEnableVertexAttribArray(aColor);
+	glDrawArraysInstancedARB(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances.size()));
+	glDisableVertexAttribArray(aColor);
+	glDisableVertexAttribArray(aTexcoord);
+	glDisableVertexAttribArray(aRect);
+	glDisableVertexAttribArray(aCorner);
+	GL_Errors("glDrawArraysInstanced");
+
+	// The divisors are global state too
+	glVertexAttribDivisorARB(aColor, 0);
+	glVertexAttribDivisorARB(aTexcoord, 0);
+	glVertexAttribDivisorARB(aRect, 0);
+#endif
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Atlas.hpp"
+#include "Sprite.hpp"
 
 #include <memory>
 
@@ -10,19 +11,6 @@ class Atlas;
 struct SDL_Window;
 struct RendererImpl;
 
-struct Sprite
-{
-	int id = 0;
-	float x = 0.f;
-	float y = 0.f;
-	float scaleX = 1.f;
-	float scaleY = 1.f;
-	float r = 1.f;
-	float g = 1.f;
-	float b = 1.f;
-	float a = 1.f;
-};
-
 class Renderer
 {
 public:
@@ -34,6 +22,10 @@ public:
 
 	void render(SDL_Window* window);
 
+	// One record per sprite drawn over a static quad, false on GL ES 2 / WebGL 1
+	bool isInstanced() const;
+	std::size_t getNumUploadedBytes() const; // By the last render()
+
 private:
 	std::unique_ptr<RendererImpl> self;
 };
@@ -2,13 +2,15 @@
 
 namespace
 {
-	std::mt19937 RandomEngine(std::random_device{}());
+	thread_local Rng RandomEngine; // Threads draw independently
+
+	constexpr std::uint64_t Multiplier = 6364136223846793005ULL;
 }
 
-Rng::Rng(unsigned int seed)
-	: m_seed(seed)
-	, m_engine(seed)
+Rng::Rng(unsigned int seed, std::uint64_t stream)
+	: m_increment((stream << 1) | 1)
 {
+	setSeed(seed);
 }
 
 unsigned int Rng::getSeed() const
@@ -18,30 +20,81 @@ unsigned int Rng::getSeed() const
 
 void Rng::setSeed(unsigned int seed)
 {
+	// pcg32_srandom_r()
 	m_seed = seed;
-	m_engine.seed(seed);
+	m_state = 0;
+	next();
+	m_state += seed;
+	next();
+}
+
+std::uint64_t Rng::getStream() const
+{
+	return m_increment >> 1;
+}
+
+std::uint64_t Rng::getState() const
+{
+	return m_state;
+}
+
+std::uint32_t Rng::next()
+{
+	const std::uint64_t state = m_state;
+	m_state = state * Multiplier + m_increment;
+
+	const auto xorShifted = static_cast<std::uint32_t>(((state >> 18) ^ state) >> 27);
+	const auto rotation = static_cast<std::uint32_t>(state >> 59);
+
+	return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+// Lemire's multiply and shift, the few biased low products are drawn again
+std::uint32_t Rng::getBounded(std::uint32_t bound)
+{
+	assert(bound > 0);
+
+	std::uint64_t product = static_cast<std::uint64_t>(next()) * bound;
+	auto low = static_cast<std::uint32_t>(product);
+
+	if (low < bound)
+	{
+		const std::uint32_t threshold = (0u - bound) % bound;
+
+		while (low < threshold)
+		{
+			product = static_cast<std::uint64_t>(next()) * bound;
+			low = static_cast<std::uint32_t>(product);
+		}
+	}
+
+	return static_cast<std::uint32_t>(product >> 32);
 }
 
 int Rng::getInt(int exclusiveMax)
 {
 	assert(exclusiveMax > 0);
-	return std::uniform_int_distribution<>(0, exclusiveMax - 1)(m_engine);
+	return static_cast<int>(getBounded(static_cast<std::uint32_t>(exclusiveMax)));
 }
 
 int Rng::getInt(int min, int inclusiveMax)
 {
 	assert(min <= inclusiveMax);
-	return min + std::uniform_int_distribution<>(0, inclusiveMax - min)(m_engine);
+
+	const std::uint32_t range = static_cast<std::uint32_t>(inclusiveMax) - static_cast<std::uint32_t>(min) + 1;
+
+	// The whole int range wraps to 0
+	const std::uint32_t offset = range ? getBounded(range) : next();
+
+	return static_cast<int>(static_cast<std::uint32_t>(min) + offset);
 }
 
 int randomInt(int exclusiveMax)
 {
-	assert(exclusiveMax > 0);
-	return std::uniform_int_distribution<>(0, exclusiveMax - 1)(RandomEngine);
+	return RandomEngine.getInt(exclusiveMax);
 }
 
 int randomInt(int min, int inclusiveMax)
 {
-	assert(min <= inclusiveMax);
-	return min + std::uniform_int_distribution<>(0, inclusiveMax - min)(RandomEngine);
+	return RandomEngine.getInt(min, inclusiveMax);
 }
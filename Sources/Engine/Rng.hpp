@@ -1,18 +1,26 @@
 #pragma once
 
-#include <random>
+#include <random> // random_device
 #include <vector>
-#include <algorithm> // shuffle
+#include <utility> // swap
+#include <cstdint>
 #include <cassert>
 
-// Random number generator
+// Random number generator, PCG32 (XSH RR) with 16 bytes of state.
+// Each stream is an independent sequence for the same seed. No standard distribution
+// is used, so a seed gives the same numbers with every compiler and standard library.
 class Rng
 {
 public:
-	explicit Rng(unsigned int seed = std::random_device()());
+	explicit Rng(unsigned int seed = std::random_device()(), std::uint64_t stream = 0);
 
 	unsigned int getSeed() const;
-	void setSeed(unsigned int seed);
+	void setSeed(unsigned int seed); // Keeps the stream
+	std::uint64_t getStream() const;
+	std::uint64_t getState() const; // Equal states draw the same numbers
+
+	std::uint32_t next(); // 32 random bits
+	std::uint32_t getBounded(std::uint32_t bound); // [0, bound), without bias
 
 	int getInt(int exclusiveMax);          // [0, max)
 	int getInt(int min, int inclusiveMax); // [min, max]
@@ -28,22 +36,23 @@ public:
 
 private:
 	unsigned int m_seed;
-	std::mt19937 m_engine;
+	std::uint64_t m_state = 0;
+	std::uint64_t m_increment; // Odd, selects the stream
 };
 
+// Fisher-Yates, std::shuffle differs between standard libraries
 template <typename T>
 void Rng::shuffle(std::vector<T>& vector)
 {
-	std::shuffle(vector.begin(), vector.end(), m_engine);
+	for (std::size_t i = vector.size(); i > 1; --i)
+		std::swap(vector[i - 1], vector[getBounded(static_cast<std::uint32_t>(i))]);
 }
 
 template <typename T>
 const T& Rng::pickOne(const std::vector<T>& vector)
 {
-	const std::size_t size = vector.size();
-	const std::size_t i = std::uniform_int_distribution<std::size_t>(0, size - 1)(m_engine);
-
-	return vector[i];
+	assert(!vector.empty());
+	return vector[getBounded(static_cast<std::uint32_t>(vector.size()))];
 }
 
 template <typename T>
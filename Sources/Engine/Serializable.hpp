@@ -1,5 +1,7 @@
 #pragma once
 
+#include "BitGrid.hpp"
+
 #include <fstream>
 #include <vector>
 #include <string>
@@ -76,12 +78,43 @@ inline void Serializable::serialize(std::ostream& os, const std::vector<bool>& d
 	}
 }
 
+// Same format as std::vector<bool>
+template <>
+inline void Serializable::serialize(std::ostream& os, const BitGrid& data)
+{
+	const std::size_t size = data.getSize();
+	serialize(os, size);
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		const bool value = data.test(i);
+		serialize(os, value);
+	}
+}
+
 template <typename T>
 void Serializable::deserialize(std::istream& is, T& data)
 {
 	is.read(reinterpret_cast<char*>(&data), sizeof(data));
 }
 
+// The grid keeps its dimensions, they are not part of the format
+template <>
+inline void Serializable::deserialize(std::istream& is, BitGrid& data)
+{
+	std::size_t size = 0;
+	deserialize(is, size);
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		bool value;
+		deserialize(is, value);
+
+		if (i < data.getSize())
+			data.set(i, value);
+	}
+}
+
 template <>
 inline void Serializable::deserialize(std::istream& is, std::string& data)
 {
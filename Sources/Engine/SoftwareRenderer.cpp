@@ -0,0 +1,508 @@
+#include "SoftwareRenderer.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm> // min, max, fill
+#include <array>
+#include <cstring> // memcpy
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTWARE_RENDERER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// x / 255 rounded to nearest, exact for every product of two bytes
+	inline std::uint32_t div255(std::uint32_t x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	std::uint32_t toPixel(std::uint32_t r, std::uint32_t g, std::uint32_t b, std::uint32_t a)
+	{
+		const std::uint8_t bytes[4] = { static_cast<std::uint8_t>(r), static_cast<std::uint8_t>(g), static_cast<std::uint8_t>(b), static_cast<std::uint8_t>(a) };
+		std::uint32_t pixel;
+		std::memcpy(&pixel, bytes, 4);
+		return pixel;
+	}
+
+	std::uint8_t toByte(float value)
+	{
+		return static_cast<std::uint8_t>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+	}
+
+	// dst = src * color * a + dst * (1 - a), a = src.a * color.a, as glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+	void blendScalar(std::uint32_t* dst, const std::uint32_t* src, int count, const std::uint8_t color[4])
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			std::uint8_t s[4], d[4];
+			std::memcpy(s, &src[i], 4);
+			std::memcpy(d, &dst[i], 4);
+
+			std::uint32_t m[4];
+			for (int c = 0; c < 4; ++c)
+				m[c] = div255(s[c] * color[c]);
+
+			const std::uint32_t a = m[3];
+
+			for (int c = 0; c < 4; ++c)
+				d[c] = static_cast<std::uint8_t>(div255(m[c] * a + d[c] * (255 - a)));
+
+			std::memcpy(&dst[i], d, 4);
+		}
+	}
+
+#ifdef SOFTWARE_RENDERER_SSE2
+	inline __m128i div255(__m128i x)
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	// Two pixels as eight 16 bit channels
+	inline __m128i blendHalf(__m128i s, __m128i d, __m128i color)
+	{
+		const __m128i m = div255(_mm_mullo_epi16(s, color));
+
+		__m128i a = _mm_shufflelo_epi16(m, _MM_SHUFFLE(3, 3, 3, 3));
+		a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+		const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+
+		return div255(_mm_add_epi16(_mm_mullo_epi16(m, a), _mm_mullo_epi16(d, inv)));
+	}
+
+	void blend(std::uint32_t* dst, const std::uint32_t* src, int count, const std::uint8_t color[4])
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i color16 = _mm_setr_epi16(color[0], color[1], color[2], color[3], color[0], color[1], color[2], color[3]);
+
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+			const __m128i lo = blendHalf(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), color16);
+			const __m128i hi = blendHalf(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), color16);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+		}
+
+		blendScalar(dst + i, src + i, count - i, color);
+	}
+#else
+	void blend(std::uint32_t* dst, const std::uint32_t* src, int count, const std::uint8_t color[4])
+	{
+		blendScalar(dst, src, count, color);
+	}
+#endif
+
+	// PNG with uncompressed deflate blocks, big but needs no zlib
+	class PngWriter
+	{
+	public:
+		explicit PngWriter(std::ofstream& ofs)
+			: m_ofs(ofs)
+		{
+			for (std::uint32_t n = 0; n < 256; ++n)
+			{
+				std::uint32_t c = n;
+				for (int k = 0; k < 8; ++k)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				m_crcTable[n] = c;
+			}
+		}
+
+		void write(const std::vector<std::uint32_t>& pixels, int width, int height)
+		{
+			static constexpr std::uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			m_ofs.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+			std::vector<std::uint8_t> header;
+			putBigEndian(header, width);
+			putBigEndian(header, height);
+			header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8 bit RGB
+			writeChunk("IHDR", header);
+
+			// Filter byte 0 then the RGB bytes of each row
+			std::vector<std::uint8_t> raw;
+			raw.reserve((width * 3 + 1) * height);
+
+			for (int y = 0; y < height; ++y)
+			{
+				raw.push_back(0);
+
+				for (int x = 0; x < width; ++x)
+				{
+					std::uint8_t rgba[4];
+					std::memcpy(rgba, &pixels[x + y * width], 4);
+					raw.insert(raw.end(), rgba, rgba + 3);
+				}
+			}
+
+			std::vector<std::uint8_t> data = { 0x78, 0x01 };
+			constexpr std::size_t maxBlock = 65535;
+
+			for (std::size_t i = 0; i < raw.size() || i == 0; i += maxBlock)
+			{
+				const std::size_t size = std::min(maxBlock, raw.size() - i);
+				const bool last = i + size == raw.size();
+
+				data.push_back(last ? 1 : 0);
+				data.push_back(size & 0xFF);
+				data.push_back((size >> 8) & 0xFF);
+				data.push_back(~size & 0xFF);
+				data.push_back((~size >> 8) & 0xFF);
+				data.insert(data.end(), raw.begin() + i, raw.begin() + i + size);
+
+				if (last)
+					break;
+			}
+
+			// Adler-32 of the uncompressed data
+			std::uint32_t a = 1, b = 0;
+			for (const std::uint8_t byte : raw)
+			{
+				a = (a + byte) % 65521;
+				b = (b + a) % 65521;
+			}
+			putBigEndian(data, (b << 16) | a);
+
+			writeChunk("IDAT", data);
+			writeChunk("IEND", {});
+		}
+
+	private:
+		static void putBigEndian(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+		{
+			for (int shift = 24; shift >= 0; shift -= 8)
+				bytes.push_back((value >> shift) & 0xFF);
+		}
+
+		void writeChunk(const char type[4], const std::vector<std::uint8_t>& data)
+		{
+			std::vector<std::uint8_t> chunk;
+			putBigEndian(chunk, static_cast<std::uint32_t>(data.size()));
+			chunk.insert(chunk.end(), type, type + 4);
+			chunk.insert(chunk.end(), data.begin(), data.end());
+
+			std::uint32_t crc = 0xFFFFFFFFu;
+			for (std::size_t i = 4; i < chunk.size(); ++i)
+				crc = m_crcTable[(crc ^ chunk[i]) & 0xFF] ^ (crc >> 8);
+			putBigEndian(chunk, crc ^ 0xFFFFFFFFu);
+
+			m_ofs.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+		}
+
+	private:
+		std::ofstream& m_ofs;
+		std::array<std::uint32_t, 256> m_crcTable;
+	};
+}
+
+SoftwareRenderer::SoftwareRenderer(Atlas& atlas, int width, int height)
+	: m_atlas(atlas)
+	, m_width(width)
+	, m_height(height)
+	, m_numBlocksX((width + BlockSize - 1) / BlockSize)
+	, m_numBlocksY((height + BlockSize - 1) / BlockSize)
+	, m_dirtyBlocks(m_numBlocksX * m_numBlocksY, 0)
+	, m_pixels(width * height)
+{
+	updateAtlas();
+}
+
+void SoftwareRenderer::clearSprites()
+{
+	m_sprites.clear();
+	m_fullRedraw = true;
+}
+
+void SoftwareRenderer::setSprites(const std::vector<Sprite>& sprites)
+{
+	updateAtlas();
+
+	if (sprites.size() != m_sprites.size())
+	{
+		m_sprites = sprites;
+		m_fullRedraw = true;
+		return;
+	}
+
+	// Both where a changed sprite was and where it is now must be redrawn
+	for (std::size_t i = 0; i < sprites.size(); ++i)
+	{
+		if (std::memcmp(&sprites[i], &m_sprites[i], sizeof(Sprite)) != 0)
+		{
+			markDirty(getRect(m_sprites[i]));
+			markDirty(getRect(sprites[i]));
+			m_sprites[i] = sprites[i];
+		}
+	}
+}
+
+void SoftwareRenderer::render()
+{
+	// Opaque black, like the glClearColor of the games
+	const std::uint32_t black = toPixel(0, 0, 0, 255);
+
+	if (m_fullRedraw)
+	{
+		std::fill(m_pixels.begin(), m_pixels.end(), black);
+
+		for (const Sprite& sprite : m_sprites)
+			drawSprite(sprite, { 0, 0, m_width, m_height });
+
+		std::fill(m_dirtyBlocks.begin(), m_dirtyBlocks.end(), 0);
+		m_fullRedraw = false;
+		return;
+	}
+
+	for (int by = 0; by < m_numBlocksY; ++by)
+	{
+		for (int bx = 0; bx < m_numBlocksX; ++bx)
+		{
+			if (!m_dirtyBlocks[bx + by * m_numBlocksX])
+				continue;
+
+			const Rect block = getBlockRect(bx, by);
+
+			for (int y = block.top; y < block.bottom; ++y)
+				std::fill(&m_pixels[block.left + y * m_width], &m_pixels[block.right + y * m_width], black);
+		}
+	}
+
+	// Every sprite is drawn again over the dirty blocks it touches, in order
+	for (const Sprite& sprite : m_sprites)
+	{
+		const Rect rect = getRect(sprite);
+
+		if (rect.left >= rect.right || rect.top >= rect.bottom)
+			continue;
+
+		for (int by = rect.top / BlockSize; by <= (rect.bottom - 1) / BlockSize; ++by)
+			for (int bx = rect.left / BlockSize; bx <= (rect.right - 1) / BlockSize; ++bx)
+				if (m_dirtyBlocks[bx + by * m_numBlocksX])
+					drawSprite(sprite, getBlockRect(bx, by));
+	}
+
+	std::fill(m_dirtyBlocks.begin(), m_dirtyBlocks.end(), 0);
+}
+
+void SoftwareRenderer::updateAtlas()
+{
+	// Same layout as the atlas, see Atlas::getSurface(). When the atlas grows the surface
+	// is replaced and the glyphs move, the locations are read again on every draw.
+	SDL_Surface* surface = m_atlas.getSurface();
+	m_atlasPixels = static_cast<const std::uint8_t*>(surface->pixels);
+	m_atlasPitch = surface->pitch;
+	m_atlasSize = surface->w;
+
+	// Tiles rewritten in place (see GlyphCache) are looked at again and drawn again
+	const int numSurfaces = m_atlas.getNumSurfaces();
+	m_revisions.resize(numSurfaces, 0);
+
+	for (int id = 0; id < numSurfaces; ++id)
+	{
+		if (m_atlas.getRevision(id) == m_revisions[id])
+			continue;
+
+		m_revisions[id] = m_atlas.getRevision(id);
+
+		if (id < static_cast<int>(m_coverage.size()))
+			m_coverage[id] = Coverage::Unknown;
+
+		for (const Sprite& sprite : m_sprites)
+			if (sprite.id == id)
+				markDirty(getRect(sprite));
+	}
+}
+
+int SoftwareRenderer::getWidth() const
+{
+	return m_width;
+}
+
+int SoftwareRenderer::getHeight() const
+{
+	return m_height;
+}
+
+const std::vector<std::uint32_t>& SoftwareRenderer::getPixels() const
+{
+	return m_pixels;
+}
+
+bool SoftwareRenderer::savePpm(const std::string& path) const
+{
+	std::ofstream ofs(path, std::ios::binary);
+
+	if (!ofs)
+		return false;
+
+	ofs << "P6\n" << m_width << ' ' << m_height << "\n255\n";
+
+	std::vector<std::uint8_t> row(m_width * 3);
+
+	for (int y = 0; y < m_height; ++y)
+	{
+		for (int x = 0; x < m_width; ++x)
+			std::memcpy(&row[x * 3], &m_pixels[x + y * m_width], 3);
+
+		ofs.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	return static_cast<bool>(ofs);
+}
+
+bool SoftwareRenderer::savePng(const std::string& path) const
+{
+	std::ofstream ofs(path, std::ios::binary);
+
+	if (!ofs)
+		return false;
+
+	PngWriter(ofs).write(m_pixels, m_width, m_height);
+
+	return static_cast<bool>(ofs);
+}
+
+SoftwareRenderer::Coverage SoftwareRenderer::getCoverage(int id)
+{
+	if (id >= static_cast<int>(m_coverage.size()))
+		m_coverage.resize(id + 1, Coverage::Unknown);
+
+	if (m_coverage[id] != Coverage::Unknown)
+		return m_coverage[id];
+
+	const SpriteLocation& loc = m_atlas.getLocation(id);
+	const int left = static_cast<int>(loc.s0 * m_atlasSize + 0.5f);
+	const int top = static_cast<int>(loc.t0 * m_atlasSize + 0.5f);
+	const int right = static_cast<int>(loc.s1 * m_atlasSize + 0.5f);
+	const int bottom = static_cast<int>(loc.t1 * m_atlasSize + 0.5f);
+
+	bool empty = true;
+	bool solid = true;
+
+	for (int y = top; y < bottom; ++y)
+	{
+		const std::uint8_t* texel = m_atlasPixels + y * m_atlasPitch + left * 4;
+
+		for (int x = left; x < right; ++x, texel += 4)
+		{
+			empty = empty && texel[3] == 0;
+			solid = solid && texel[0] == 255 && texel[1] == 255 && texel[2] == 255 && texel[3] == 255;
+		}
+	}
+
+	m_coverage[id] = empty ? Coverage::Empty : solid ? Coverage::Solid : Coverage::Blended;
+
+	return m_coverage[id];
+}
+
+SoftwareRenderer::Rect SoftwareRenderer::getRect(const Sprite& sprite) const
+{
+	const SpriteLocation& loc = m_atlas.getLocation(sprite.id);
+
+	const int left = static_cast<int>(sprite.x + 0.5f);
+	const int top = static_cast<int>(sprite.y + 0.5f);
+	const int width = static_cast<int>((loc.x1 - loc.x0) * sprite.scaleX + 0.5f);
+	const int height = static_cast<int>((loc.y1 - loc.y0) * sprite.scaleY + 0.5f);
+
+	// Clipped to the framebuffer
+	return { std::max(left, 0), std::max(top, 0), std::min(left + width, m_width), std::min(top + height, m_height) };
+}
+
+SoftwareRenderer::Rect SoftwareRenderer::getBlockRect(int bx, int by) const
+{
+	return { bx * BlockSize, by * BlockSize, std::min((bx + 1) * BlockSize, m_width), std::min((by + 1) * BlockSize, m_height) };
+}
+
+void SoftwareRenderer::markDirty(const Rect& rect)
+{
+	if (m_fullRedraw || rect.left >= rect.right || rect.top >= rect.bottom)
+		return;
+
+	for (int by = rect.top / BlockSize; by <= (rect.bottom - 1) / BlockSize; ++by)
+		for (int bx = rect.left / BlockSize; bx <= (rect.right - 1) / BlockSize; ++bx)
+			m_dirtyBlocks[bx + by * m_numBlocksX] = 1;
+}
+
+void SoftwareRenderer::drawSprite(const Sprite& sprite, const Rect& clip)
+{
+	const std::uint8_t color[4] = { toByte(sprite.r), toByte(sprite.g), toByte(sprite.b), toByte(sprite.a) };
+
+	if (color[3] == 0)
+		return;
+
+	const Coverage coverage = getCoverage(sprite.id);
+
+	if (coverage == Coverage::Empty)
+		return;
+
+	const SpriteLocation& loc = m_atlas.getLocation(sprite.id);
+	const int srcLeft = static_cast<int>(loc.s0 * m_atlasSize + 0.5f);
+	const int srcTop = static_cast<int>(loc.t0 * m_atlasSize + 0.5f);
+	const int srcWidth = static_cast<int>(loc.s1 * m_atlasSize + 0.5f) - srcLeft;
+	const int srcHeight = static_cast<int>(loc.t1 * m_atlasSize + 0.5f) - srcTop;
+
+	const int dstLeft = static_cast<int>(sprite.x + 0.5f);
+	const int dstTop = static_cast<int>(sprite.y + 0.5f);
+	const int dstWidth = static_cast<int>((loc.x1 - loc.x0) * sprite.scaleX + 0.5f);
+	const int dstHeight = static_cast<int>((loc.y1 - loc.y0) * sprite.scaleY + 0.5f);
+
+	if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+		return;
+
+	const int left = std::max(dstLeft, clip.left);
+	const int top = std::max(dstTop, clip.top);
+	const int right = std::min(dstLeft + dstWidth, clip.right);
+	const int bottom = std::min(dstTop + dstHeight, clip.bottom);
+
+	if (left >= right || top >= bottom)
+		return;
+
+	// An opaque color on a solid tile overwrites the framebuffer
+	if (coverage == Coverage::Solid && color[3] == 255)
+	{
+		const std::uint32_t pixel = toPixel(color[0], color[1], color[2], 255);
+
+		for (int y = top; y < bottom; ++y)
+			std::fill(&m_pixels[left + y * m_width], &m_pixels[right + y * m_width], pixel);
+
+		return;
+	}
+
+	const bool scaled = srcWidth != dstWidth || srcHeight != dstHeight;
+	int rowY = -1; // Source row in m_row
+
+	for (int y = top; y < bottom; ++y)
+	{
+		// Nearest texel, like the GL_NEAREST filter of the atlas texture
+		const int srcY = srcTop + (y - dstTop) * srcHeight / dstHeight;
+		const auto* texels = reinterpret_cast<const std::uint32_t*>(m_atlasPixels + srcY * m_atlasPitch) + srcLeft;
+		const std::uint32_t* src = texels + (left - dstLeft);
+
+		// A stretched row is gathered once, then reused by every line it covers
+		if (scaled)
+		{
+			if (srcY != rowY)
+			{
+				m_row.resize(right - left);
+
+				for (int x = left; x < right; ++x)
+					m_row[x - left] = texels[(x - dstLeft) * srcWidth / dstWidth];
+
+				rowY = srcY;
+			}
+
+			src = m_row.data();
+		}
+
+		blend(&m_pixels[left + y * m_width], src, right - left, color);
+	}
+}
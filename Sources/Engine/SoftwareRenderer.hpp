@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Atlas.hpp"
+#include "Sprite.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Draws sprites into a framebuffer in memory, no window or OpenGL context needed.
+// Blending matches the OpenGL renderer: color * texel, then src alpha over the framebuffer.
+// Only the blocks under sprites that changed since the last frame are drawn again.
+class SoftwareRenderer
+{
+public:
+	SoftwareRenderer(Atlas& atlas, int width, int height);
+
+	void clearSprites();
+	void setSprites(const std::vector<Sprite>& sprites);
+
+	void render();
+
+	int getWidth() const;
+	int getHeight() const;
+	const std::vector<std::uint32_t>& getPixels() const; // R, G, B, A bytes in memory order
+
+	bool savePpm(const std::string& path) const;
+	bool savePng(const std::string& path) const;
+
+private:
+	// What the atlas holds under a sprite, decides how it is drawn
+	enum class Coverage
+	{
+		Empty,   // Fully transparent, nothing to draw
+		Solid,   // Opaque white, the sprite color is drawn as is
+		Blended,
+		Unknown, // Not looked at yet
+	};
+
+	struct Rect
+	{
+		int left, top, right, bottom;
+	};
+
+	void updateAtlas(); // Packs the new glyphs, the surface may have been replaced or rewritten
+	Coverage getCoverage(int id);
+	Rect getRect(const Sprite& sprite) const;
+	Rect getBlockRect(int bx, int by) const;
+	void markDirty(const Rect& rect);
+	void drawSprite(const Sprite& sprite, const Rect& clip);
+
+private:
+	static constexpr int BlockSize = 16; // Pixels
+
+	Atlas& m_atlas;
+	int m_width;
+	int m_height;
+	int m_numBlocksX;
+	int m_numBlocksY;
+	std::vector<std::uint8_t> m_dirtyBlocks;
+	bool m_fullRedraw = true;
+	const std::uint8_t* m_atlasPixels = nullptr;
+	int m_atlasPitch = 0;
+	int m_atlasSize = 0;
+	std::vector<Coverage> m_coverage; // Per sprite id, filled on first use
+	std::vector<unsigned> m_revisions; // Per sprite id, see Atlas::updateSurface()
+	std::vector<Sprite> m_sprites;
+	std::vector<std::uint32_t> m_pixels;
+	std::vector<std::uint32_t> m_row; // Source texels of a scaled sprite
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+struct Sprite
+{
+	int id = 0;
+	float x = 0.f;
+	float y = 0.f;
+	float scaleX = 1.f;
+	float scaleY = 1.f;
+	float r = 1.f;
+	float g = 1.f;
+	float b = 1.f;
+	float a = 1.f;
+};
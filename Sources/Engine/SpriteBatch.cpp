@@ -0,0 +1,73 @@
+#include "SpriteBatch.hpp"
+
+#include <algorithm> // max
+
+void SpriteBatch::clear()
+{
+	m_vertices.clear();
+	m_changedRanges.clear();
+	m_resized = true;
+}
+
+std::size_t SpriteBatch::getNumSprites() const
+{
+	return m_vertices.size() / 4;
+}
+
+const std::vector<SpriteBatch::Vertex>& SpriteBatch::getVertices() const
+{
+	return m_vertices;
+}
+
+bool SpriteBatch::isResized() const
+{
+	return m_resized;
+}
+
+const std::vector<SpriteBatch::Range>& SpriteBatch::getChangedRanges() const
+{
+	return m_changedRanges;
+}
+
+void SpriteBatch::markUploaded()
+{
+	m_changedRanges.clear();
+	m_resized = false;
+}
+
+void SpriteBatch::makeIndices(std::vector<std::uint32_t>& indices, std::size_t numSprites)
+{
+	constexpr std::uint32_t cornerIndex[6] = { 0, 1, 2, 2, 1, 3 };
+
+	std::size_t i = indices.size();
+	indices.resize(numSprites * 6);
+	for (; i < indices.size(); ++i)
+	{
+		const std::uint32_t j = static_cast<std::uint32_t>(i / 6);
+		indices[i] = j * 4 + cornerIndex[i % 6];
+	}
+}
+
+void SpriteBatch::markChanged(std::size_t sprite)
+{
+	// The whole buffer is uploaded anyway
+	if (m_resized)
+		return;
+
+	const std::size_t first = sprite * 4;
+
+	if (!m_changedRanges.empty())
+	{
+		Range& last = m_changedRanges.back();
+		const std::size_t end = last.first + last.count;
+
+		// Sprites are visited in order, except after a second setSprites() before the upload
+		if (first >= last.first && first <= end + m_maxGap)
+		{
+			last.count = std::max(end, first + 4) - last.first;
+			return;
+		}
+	}
+
+	m_changedRanges.push_back({ first, 4 });
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Atlas.hpp"
+#include "Sprite.hpp"
+
+#include <cstdint>
+#include <cstring> // memcmp
+#include <vector>
+
+// Quads of a sprite list in a packed vertex format, four vertices per sprite.
+// Vertices that did not change since the last upload are not uploaded again,
+// the renderer only sends the ranges that did, see getChangedRanges().
+class SpriteBatch
+{
+public:
+	struct Vertex
+	{
+		std::int16_t position[2];  // World coordinates
+		std::uint16_t texcoord[2]; // Normalized texture s,t
+		std::uint8_t color[4];
+	};
+
+	// Vertices [first, first + count)
+	struct Range
+	{
+		std::size_t first;
+		std::size_t count;
+	};
+
+public:
+	// getLocation(int id) returns the SpriteLocation of a sprite id, see Atlas::getLocation()
+	template <typename LocationFn>
+	void setSprites(const std::vector<Sprite>& sprites, LocationFn getLocation);
+	void clear();
+
+	std::size_t getNumSprites() const;
+	const std::vector<Vertex>& getVertices() const;
+
+	// Changes since the last markUploaded(), the whole buffer when it was resized
+	bool isResized() const;
+	const std::vector<Range>& getChangedRanges() const;
+	void markUploaded();
+
+	// Two triangles per sprite, the same for every batch with that many sprites
+	static void makeIndices(std::vector<std::uint32_t>& indices, std::size_t numSprites);
+
+private:
+	void markChanged(std::size_t sprite);
+
+private:
+	// Uploading a few unchanged sprites costs less than another glBufferSubData call
+	static constexpr std::size_t m_maxGap = 8 * 4;
+
+	std::vector<Vertex> m_vertices;
+	std::vector<Range> m_changedRanges;
+	bool m_resized = true;
+};
+
+template <typename LocationFn>
+void SpriteBatch::setSprites(const std::vector<Sprite>& sprites, LocationFn getLocation)
+{
+	if (m_vertices.size() != sprites.size() * 4)
+	{
+		m_vertices.resize(sprites.size() * 4);
+		m_resized = true;
+		m_changedRanges.clear();
+	}
+
+	// Rounded to nearest, std::lround is a library call on most targets
+	const auto round = [] (float value) { return static_cast<int>(value >= 0.f ? value + 0.5f : value - 0.5f); };
+	const auto toShort = [&] (float value) { return static_cast<std::int16_t>(round(value)); };
+	const auto toUnorm16 = [&] (float value) { return static_cast<std::uint16_t>(round(value * 65535.f)); };
+	const auto toUnorm8 = [&] (float value) { return static_cast<std::uint8_t>(round(value * 255.f)); };
+
+	for (std::size_t i = 0; i < sprites.size(); ++i)
+	{
+		const Sprite& S = sprites[i];
+		const SpriteLocation& loc = getLocation(S.id);
+
+		const float x0 = S.x;
+		const float y0 = S.y;
+		const float x1 = S.x + (loc.x1 - loc.x0) * S.scaleX;
+		const float y1 = S.y + (loc.y1 - loc.y0) * S.scaleY;
+
+		Vertex vertex[4];
+
+		vertex[0] = { { toShort(x0), toShort(y0) }, { toUnorm16(loc.s0), toUnorm16(loc.t0) }, {} };
+		vertex[1] = { { toShort(x1), toShort(y0) }, { toUnorm16(loc.s1), toUnorm16(loc.t0) }, {} };
+		vertex[2] = { { toShort(x0), toShort(y1) }, { toUnorm16(loc.s0), toUnorm16(loc.t1) }, {} };
+		vertex[3] = { { toShort(x1), toShort(y1) }, { toUnorm16(loc.s1), toUnorm16(loc.t1) }, {} };
+
+		for (auto& v : vertex)
+		{
+			v.color[0] = toUnorm8(S.r);
+			v.color[1] = toUnorm8(S.g);
+			v.color[2] = toUnorm8(S.b);
+			v.color[3] = toUnorm8(S.a);
+		}
+
+		Vertex* const dest = &m_vertices[i * 4];
+
+		if (std::memcmp(dest, vertex, sizeof(vertex)) != 0)
+		{
+			std::memcpy(dest, vertex, sizeof(vertex));
+			markChanged(i);
+		}
+	}
+}
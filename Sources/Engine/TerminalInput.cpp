@@ -0,0 +1,183 @@
+#include "TerminalInput.hpp"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#define TERMINAL_INPUT
+#else
+struct termios {};
+#endif
+
+namespace
+{
+	constexpr char Escape = '\x1b';
+	constexpr char CtrlC = '\x03';
+}
+
+TerminalInput::TerminalInput()
+{
+#ifdef TERMINAL_INPUT
+	if (!isatty(STDIN_FILENO))
+		return;
+
+	termios mode;
+	if (tcgetattr(STDIN_FILENO, &mode) != 0)
+		return;
+
+	m_savedMode = std::make_unique<termios>(mode);
+
+	// Byte by byte, no echo, and Ctrl+C arrives as a key so the game can save and quit
+	mode.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+	mode.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+	mode.c_cc[VMIN] = 0;
+	mode.c_cc[VTIME] = 0;
+
+	if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &mode) != 0)
+		m_savedMode = nullptr;
+#endif
+}
+
+TerminalInput::~TerminalInput()
+{
+#ifdef TERMINAL_INPUT
+	if (m_savedMode)
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, m_savedMode.get());
+#endif
+}
+
+bool TerminalInput::isOpen() const
+{
+	return m_savedMode != nullptr;
+}
+
+void TerminalInput::wait(int timeout)
+{
+#ifdef TERMINAL_INPUT
+	if (!isOpen())
+		return;
+
+	pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+	poll(&fd, 1, timeout);
+#else
+	(void)timeout;
+#endif
+}
+
+void TerminalInput::pushEvents()
+{
+#ifdef TERMINAL_INPUT
+	if (!isOpen())
+		return;
+
+	char buffer[64];
+
+	for (ssize_t count; (count = read(STDIN_FILENO, buffer, sizeof(buffer))) > 0; )
+		m_pending.append(buffer, count);
+
+	decode();
+#endif
+}
+
+void TerminalInput::decode()
+{
+	std::size_t i = 0;
+
+	while (i < m_pending.size())
+	{
+		const char ch = m_pending[i];
+
+		if (ch == Escape)
+		{
+			// A lone escape is the key, the arrows and such arrive in a single read
+			if (i + 1 == m_pending.size() || (m_pending[i + 1] != '[' && m_pending[i + 1] != 'O'))
+			{
+				pushKey(SDLK_ESCAPE);
+				++i;
+				continue;
+			}
+
+			// CSI or SS3: parameter bytes, then the final byte
+			std::size_t end = i + 2;
+			while (end < m_pending.size() && m_pending[end] >= '0' && m_pending[end] <= '?')
+				++end;
+
+			// The rest of the sequence comes with the next read
+			if (end == m_pending.size())
+				break;
+
+			const SDL_Keycode key = getSequenceKey(m_pending[end], m_pending.substr(i + 2, end - i - 2));
+			if (key != SDLK_UNKNOWN)
+				pushKey(key);
+
+			i = end + 1;
+			continue;
+		}
+
+		if (ch == CtrlC)
+		{
+			SDL_Event event{};
+			event.type = SDL_QUIT;
+			SDL_PushEvent(&event);
+		}
+
+		else if (ch == '\r' || ch == '\n')
+			pushKey(SDLK_RETURN);
+		else if (ch == '\t')
+			pushKey(SDLK_TAB);
+		else if (ch == '\x7f' || ch == '\b')
+			pushKey(SDLK_BACKSPACE);
+
+		// Keycodes of printable keys are their unshifted characters
+		else if (ch >= 'A' && ch <= 'Z')
+			pushKey(static_cast<SDL_Keycode>(ch - 'A' + 'a'));
+		else if (ch >= ' ' && ch <= '~')
+			pushKey(static_cast<SDL_Keycode>(ch));
+
+		++i;
+	}
+
+	m_pending.erase(0, i);
+}
+
+void TerminalInput::pushKey(SDL_Keycode key)
+{
+	SDL_Event event{};
+	event.type = SDL_KEYDOWN;
+	event.key.keysym.sym = key;
+	SDL_PushEvent(&event);
+}
+
+// xterm and VT220 sequences, keypad 5 sends 'E' with num lock off
+SDL_Keycode TerminalInput::getSequenceKey(char final, const std::string& parameters)
+{
+	switch (final)
+	{
+	case 'A': return SDLK_UP;
+	case 'B': return SDLK_DOWN;
+	case 'C': return SDLK_RIGHT;
+	case 'D': return SDLK_LEFT;
+	case 'E': return SDLK_CLEAR;
+	case 'H': return SDLK_HOME;
+	case 'F': return SDLK_END;
+	case 'M': return SDLK_KP_ENTER;
+	}
+
+	if (final != '~')
+		return SDLK_UNKNOWN;
+
+	const std::string number = parameters.substr(0, parameters.find(';'));
+
+	if (number == "1" || number == "7")
+		return SDLK_HOME;
+	if (number == "2")
+		return SDLK_INSERT;
+	if (number == "4" || number == "8")
+		return SDLK_END;
+	if (number == "5")
+		return SDLK_PAGEUP;
+	if (number == "6")
+		return SDLK_PAGEDOWN;
+
+	return SDLK_UNKNOWN;
+}
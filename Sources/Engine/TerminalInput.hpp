@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <memory>
+#include <string>
+
+struct termios;
+
+// Reads the keyboard of the terminal TerminalRenderer draws in, to play over SSH.
+// stdin stays in raw mode while this lives. Typed keys, arrows and the other escape
+// sequences included, become SDL_KEYDOWN events, Ctrl+C becomes SDL_QUIT.
+// Only on POSIX terminals, isOpen() is false elsewhere.
+class TerminalInput
+{
+public:
+	TerminalInput();
+	~TerminalInput(); // Restores the terminal mode
+
+	TerminalInput(const TerminalInput&) = delete;
+	TerminalInput& operator=(const TerminalInput&) = delete;
+
+	bool isOpen() const; // stdin is a terminal in raw mode
+
+	void wait(int timeout); // Until something is typed, or timeout milliseconds passed
+	void pushEvents(); // Reads what was typed without blocking
+
+private:
+	void decode();
+	void pushKey(SDL_Keycode key);
+	static SDL_Keycode getSequenceKey(char final, const std::string& parameters);
+
+private:
+	std::unique_ptr<termios> m_savedMode; // Set while in raw mode
+	std::string m_pending; // Bytes of an escape sequence not fully read yet
+};
@@ -0,0 +1,301 @@
+#include "TerminalRenderer.hpp"
+#include "Console.hpp"
+
+#include <utility> // pair
+
+namespace
+{
+	std::uint8_t mix(std::uint8_t from, std::uint8_t to, std::uint8_t alpha)
+	{
+		return static_cast<std::uint8_t>((from * (255 - alpha) + to * alpha + 127) / 255);
+	}
+
+	std::size_t getNumDigits(int value)
+	{
+		std::size_t numDigits = 1;
+
+		for (; value >= 10; value /= 10)
+			++numDigits;
+
+		return numDigits;
+	}
+
+	// East Asian wide and fullwidth ranges, then the common zero width ones: combining marks,
+	// joiners and variation selectors. Everything else takes one column.
+	constexpr std::pair<char32_t, char32_t> WideRanges[] =
+	{
+		{ 0x1100, 0x115F }, { 0x2329, 0x232A }, { 0x2E80, 0x303E }, { 0x3041, 0x33FF },
+		{ 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF }, { 0xA000, 0xA4CF }, { 0xAC00, 0xD7A3 },
+		{ 0xF900, 0xFAFF }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6F }, { 0xFF00, 0xFF60 },
+		{ 0xFFE0, 0xFFE6 }, { 0x1F300, 0x1F64F }, { 0x1F900, 0x1F9FF }, { 0x20000, 0x2FFFD },
+		{ 0x30000, 0x3FFFD },
+	};
+
+	constexpr std::pair<char32_t, char32_t> ZeroWidthRanges[] =
+	{
+		{ 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x0610, 0x061A },
+		{ 0x064B, 0x065F }, { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F },
+		{ 0x202A, 0x202E }, { 0x2060, 0x2064 }, { 0x20D0, 0x20FF }, { 0xFE00, 0xFE0F },
+		{ 0xFE20, 0xFE2F }, { 0xFEFF, 0xFEFF }, { 0xE0100, 0xE01EF },
+	};
+
+	bool isNarrow(char32_t ch)
+	{
+		for (const auto& [first, last] : WideRanges)
+			if (ch >= first && ch <= last)
+				return false;
+
+		for (const auto& [first, last] : ZeroWidthRanges)
+			if (ch >= first && ch <= last)
+				return false;
+
+		return true;
+	}
+
+	void appendColor(std::string& buffer, std::uint32_t rgb)
+	{
+		buffer += std::to_string((rgb >> 16) & 0xFF);
+		buffer += ';';
+		buffer += std::to_string((rgb >> 8) & 0xFF);
+		buffer += ';';
+		buffer += std::to_string(rgb & 0xFF);
+	}
+}
+
+bool TerminalRenderer::Cell::operator==(const Cell& other) const
+{
+	return ch == other.ch && fg == other.fg && bg == other.bg;
+}
+
+bool TerminalRenderer::Cell::operator!=(const Cell& other) const
+{
+	return !(*this == other);
+}
+
+TerminalRenderer::TerminalRenderer(std::ostream& os)
+	: m_os(os)
+{
+}
+
+TerminalRenderer::~TerminalRenderer()
+{
+	// Default colors, visible cursor, and the prompt below the console
+	m_buffer = "\x1b[0m\x1b[?25h\x1b[" + std::to_string(m_height + 1) + ";1H";
+	m_os.write(m_buffer.data(), m_buffer.size());
+	m_os.flush();
+}
+
+void TerminalRenderer::render(const Console& console)
+{
+	m_buffer.clear();
+	m_numChangedCells = 0;
+
+	if (console.getWidth() != m_width || console.getHeight() != m_height)
+	{
+		m_width = console.getWidth();
+		m_height = console.getHeight();
+		invalidate();
+
+		// Hide the cursor, reset the colors and clear the screen
+		m_buffer += "\x1b[?25l\x1b[0m\x1b[2J";
+	}
+
+	std::vector<Cell> cells(m_width * m_height);
+
+	for (int y = 0; y < m_height; ++y)
+		for (int x = 0; x < m_width; ++x)
+			cells[x + y * m_width] = getCell(console, x, y);
+
+	for (int y = 0; y < m_height; ++y)
+	{
+		for (int x = 0; x < m_width; ++x)
+		{
+			const Cell& cell = cells[x + y * m_width];
+			Cell& onScreen = m_screen[x + y * m_width];
+
+			if (cell == onScreen)
+				continue;
+
+			moveCursor(x, y, cells);
+			setColors(cell);
+			putChar(cell.ch);
+
+			onScreen = cell;
+			++m_numChangedCells;
+		}
+	}
+
+	if (!m_buffer.empty())
+	{
+		m_os.write(m_buffer.data(), m_buffer.size());
+		m_os.flush();
+	}
+}
+
+void TerminalRenderer::invalidate()
+{
+	// Never equal to a cell of a console
+	m_screen.assign(m_width * m_height, Cell{ '\0', NoColor, NoColor });
+	m_cursorX = -1;
+	m_cursorY = -1;
+	m_fg = NoColor;
+	m_bg = NoColor;
+}
+
+std::size_t TerminalRenderer::getNumBytes() const
+{
+	return m_buffer.size();
+}
+
+std::size_t TerminalRenderer::getNumChangedCells() const
+{
+	return m_numChangedCells;
+}
+
+TerminalRenderer::Cell TerminalRenderer::getCell(const Console& console, int x, int y)
+{
+	const Color fgColor = console.getColor(x, y);
+	const Color bgColor = console.getBgColor(x, y);
+
+	// The background is drawn over black, the glyph over the background
+	const std::uint8_t bg[3] = { mix(0, bgColor.r, bgColor.a), mix(0, bgColor.g, bgColor.a), mix(0, bgColor.b, bgColor.a) };
+	const std::uint8_t fg[3] = { mix(bg[0], fgColor.r, fgColor.a), mix(bg[1], fgColor.g, fgColor.a), mix(bg[2], fgColor.b, fgColor.a) };
+
+	Cell cell;
+	cell.ch = console.getChar(x, y);
+	cell.bg = (bg[0] << 16) | (bg[1] << 8) | bg[2];
+	cell.fg = (fg[0] << 16) | (fg[1] << 8) | fg[2];
+
+	// A blank only shows its background, its color changing must not redraw it
+	if (cell.ch == ' ')
+		cell.fg = cell.bg;
+
+	return cell;
+}
+
+void TerminalRenderer::moveCursor(int x, int y, const std::vector<Cell>& cells)
+{
+	if (x == m_cursorX && y == m_cursorY)
+		return;
+
+	// Cursor position, 1-based
+	std::size_t bestCost = 4 + getNumDigits(y + 1) + getNumDigits(x + 1);
+	enum { Position, Forward, Reprint, NewLine } best = Position;
+
+	if (y == m_cursorY && x > m_cursorX)
+	{
+		const int gap = x - m_cursorX;
+
+		// Cursor forward
+		const std::size_t forwardCost = gap == 1 ? 3 : 3 + getNumDigits(gap);
+		if (forwardCost < bestCost)
+		{
+			bestCost = forwardCost;
+			best = Forward;
+		}
+
+		// Writing the unchanged cells again, when they are plain characters in the current colors
+		if (static_cast<std::size_t>(gap) < bestCost)
+		{
+			bool reprint = true;
+
+			for (int i = m_cursorX; i < x && reprint; ++i)
+			{
+				const Cell& cell = cells[i + y * m_width];
+				reprint = cell.ch >= ' ' && cell.ch <= '~' && cell.bg == m_bg && (cell.ch == ' ' || cell.fg == m_fg);
+			}
+
+			if (reprint)
+				best = Reprint;
+		}
+	}
+
+	else if (y == m_cursorY + 1 && x == 0 && m_cursorY >= 0 && 2 < bestCost)
+		best = NewLine;
+
+	switch (best)
+	{
+	case Position:
+		m_buffer += "\x1b[" + std::to_string(y + 1) + ';' + std::to_string(x + 1) + 'H';
+		break;
+
+	case Forward:
+		m_buffer += x - m_cursorX == 1 ? std::string("\x1b[C") : "\x1b[" + std::to_string(x - m_cursorX) + 'C';
+		break;
+
+	case Reprint:
+		for (int i = m_cursorX; i < x; ++i)
+			m_buffer += static_cast<char>(cells[i + y * m_width].ch);
+		break;
+
+	case NewLine:
+		m_buffer += "\r\n";
+		break;
+	}
+
+	m_cursorX = x;
+	m_cursorY = y;
+}
+
+void TerminalRenderer::setColors(const Cell& cell)
+{
+	const bool fgChanged = cell.ch != ' ' && cell.fg != m_fg;
+	const bool bgChanged = cell.bg != m_bg;
+
+	if (!fgChanged && !bgChanged)
+		return;
+
+	// Both colors in a single sequence when they both change
+	m_buffer += "\x1b[";
+
+	if (fgChanged)
+	{
+		m_buffer += "38;2;";
+		appendColor(m_buffer, cell.fg);
+		m_fg = cell.fg;
+	}
+
+	if (fgChanged && bgChanged)
+		m_buffer += ';';
+
+	if (bgChanged)
+	{
+		m_buffer += "48;2;";
+		appendColor(m_buffer, cell.bg);
+		m_bg = cell.bg;
+	}
+
+	m_buffer += 'm';
+}
+
+void TerminalRenderer::putChar(char32_t ch)
+{
+	// UTF-8, control characters and surrogates would break the output.
+	// Glyphs that don't take exactly one column would shift the rest of the row,
+	// the window clips them to their cell too.
+	if (ch >= ' ' && ch <= '~')
+		m_buffer += static_cast<char>(ch);
+	else if (ch < 0xA0 || (ch >= 0xD800 && ch <= 0xDFFF) || ch > 0x10FFFF || !isNarrow(ch))
+		m_buffer += '?';
+	else if (ch < 0x800)
+	{
+		m_buffer += static_cast<char>(0xC0 | (ch >> 6));
+		m_buffer += static_cast<char>(0x80 | (ch & 0x3F));
+	}
+	else if (ch < 0x10000)
+	{
+		m_buffer += static_cast<char>(0xE0 | (ch >> 12));
+		m_buffer += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+		m_buffer += static_cast<char>(0x80 | (ch & 0x3F));
+	}
+	else
+	{
+		m_buffer += static_cast<char>(0xF0 | (ch >> 18));
+		m_buffer += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+		m_buffer += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+		m_buffer += static_cast<char>(0x80 | (ch & 0x3F));
+	}
+
+	// Past the last column the terminal waits to wrap, only "\r\n" or a position moves from there
+	++m_cursorX;
+}
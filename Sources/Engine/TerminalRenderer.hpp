@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Console;
+
+// Draws a console in a terminal with ANSI escape sequences and 24-bit colors.
+// Only the cells that changed since the last frame are written, colors are only
+// sent when they change and the cursor is only moved over unchanged cells.
+class TerminalRenderer
+{
+public:
+	explicit TerminalRenderer(std::ostream& os);
+	~TerminalRenderer(); // Restores the terminal colors and cursor
+
+	TerminalRenderer(const TerminalRenderer&) = delete;
+	TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+	void render(const Console& console);
+	void invalidate(); // The next frame redraws every cell
+
+	// Output of the last render()
+	std::size_t getNumBytes() const;
+	std::size_t getNumChangedCells() const;
+
+private:
+	// Colors as seen on screen, alpha already blended over the black background
+	struct Cell
+	{
+		char32_t ch;
+		std::uint32_t fg; // 0xRRGGBB
+		std::uint32_t bg;
+
+		bool operator==(const Cell& other) const;
+		bool operator!=(const Cell& other) const;
+	};
+
+	static Cell getCell(const Console& console, int x, int y);
+
+	void moveCursor(int x, int y, const std::vector<Cell>& cells);
+	void setColors(const Cell& cell);
+	void putChar(char32_t ch);
+
+private:
+	static constexpr std::uint32_t NoColor = 0xFFFFFFFF;
+
+	std::ostream& m_os;
+	std::string m_buffer; // A whole frame is written at once
+	int m_width = 0;
+	int m_height = 0;
+	std::vector<Cell> m_screen; // What the terminal shows
+	int m_cursorX = -1; // -1 when unknown, m_width after the last column
+	int m_cursorY = -1;
+	std::uint32_t m_fg = NoColor;
+	std::uint32_t m_bg = NoColor;
+	std::size_t m_numChangedCells = 0;
+};
@@ -4,7 +4,7 @@
 #include "Engine/Rng.hpp"
 
 #include <unordered_map>
-#include <algorithm> // max
+#include <algorithm> // max, max_element
 
 struct ActorData
 {
@@ -14,15 +14,17 @@ struct ActorData
 	int attack;
 	int defense;
 	int xp;
+	int sightRange;
+	int speed;
 };
 
 namespace
 {
 	const std::unordered_map<std::string, ActorData> Table =
 	{
-		{ "you",   { '@', 0xFFFFFF, 100, 2, 1, 0   } },
-		{ "orc",   { 'o', 0x14A02E, 20,  4, 0, 35  } },
-		{ "troll", { 'T', 0x1A7A3E, 30,  8, 2, 100 } },
+		{ "you",   { '@', 0xFFFFFF, 100, 2, 1, 0,   10, 100 } },
+		{ "orc",   { 'o', 0x14A02E, 20,  4, 0, 35,  8,  100 } },
+		{ "troll", { 'T', 0x1A7A3E, 30,  8, 2, 100, 6,  100 } },
 	};
 }
 
@@ -42,7 +44,7 @@ std::string_view Actor::getName() const
 
 bool Actor::isPlayer() const
 {
-	return this == s_world->getPlayerActor();
+	return false;
 }
 
 bool Actor::isDestroyed() const
@@ -75,6 +77,29 @@ int Actor::getXp() const
 	return m_data.xp;
 }
 
+int Actor::getSightRange() const
+{
+	return m_data.sightRange;
+}
+
+int Actor::getMaxSightRange()
+{
+	static const int maxSightRange = std::max_element(Table.begin(), Table.end(),
+		[] (const auto& a, const auto& b) { return a.second.sightRange < b.second.sightRange; })->second.sightRange;
+
+	return maxSightRange;
+}
+
+int Actor::getSpeed() const
+{
+	return m_data.speed;
+}
+
+int Actor::getDelay(int cost) const
+{
+	return std::max(1, cost * NormalSpeed / getSpeed());
+}
+
 void Actor::takeDamage(int damage)
 {
 	if (damage > 0)
@@ -86,7 +111,7 @@ void Actor::restoreHp(int points)
 	m_hp = std::min(m_hp + points, getMaxHp());
 }
 
-void Actor::attack(Actor& target)
+void Actor::attack(World& world, Actor& target)
 {
 	const int damage = std::max(0, getAttack() - target.getDefense());
 	target.takeDamage(damage);
@@ -95,7 +120,7 @@ void Actor::attack(Actor& target)
 	std::string message = getTheName() + " hit " + target.getTheName()
 		+ " for " + std::to_string(damage) + " damage.";
 
-	s_world->addMessage(std::move(message));
+	world.addMessage(std::move(message));
 
 	if (target.isDestroyed())
 	{
@@ -104,9 +129,9 @@ void Actor::attack(Actor& target)
 		else
 			message = target.getTheName() + " is dead.";
 
-		s_world->addMessage(std::move(message));
-		s_world->closeDoor(target.getPosition());
-		s_world->markRemoveWrecks();
+		world.addMessage(std::move(message));
+		world.closeDoor(target.getPosition());
+		world.markRemoveWrecks();
 	}
 }
 
@@ -120,10 +145,11 @@ void Actor::setTarget(Actor* target)
 	m_target = target;
 }
 
-void Actor::updateAi()
+int Actor::updateAi(World& world)
 {
+	// Waiting for a status effect to wear off takes a turn too
 	if (!m_target)
-		return;
+		return ActionCost;
 
 	const Vec2i targetPos = m_target->getPosition();
 
@@ -134,56 +160,61 @@ void Actor::updateAi()
 
 		do
 		{
-			dx = randomInt(-1, 1);
-			dy = randomInt(-1, 1);
+			dx = world.getRng().getInt(-1, 1);
+			dy = world.getRng().getInt(-1, 1);
 		} while (dx == 0 && dy == 0);
 
 		Vec2i nextPos;
 		nextPos.x = m_position.x + dx;
 		nextPos.y = m_position.y + dy;
 
-		if (Actor* actor = s_world->getActor(nextPos))
-			attack(*actor);
+		if (Actor* actor = world.getActor(nextPos))
+			attack(world, *actor);
 
-		else if (s_world->isPassable(nextPos))
+		else if (world.isPassable(nextPos))
 		{
-			s_world->closeDoor(m_position);
+			world.closeDoor(m_position);
 			setPosition(nextPos);
-			s_world->openDoor(m_position);
+			world.openDoor(m_position);
 		}
 	}
 
 	else if ((targetPos - m_position).lengthSquared() <= 2)
-		attack(*m_target);
+		attack(world, *m_target);
 
 	else
 	{
-		const auto path = s_world->findPath(targetPos, m_position);
+		const Vec2i nextPos = world.getNextStep(m_position, targetPos);
 
-		if (path.size() > 2)
+		if (nextPos != m_position)
 		{
-			s_world->closeDoor(m_position);
-
-			const Vec2i nextPos = path[1];
+			world.closeDoor(m_position);
 
-			if (s_world->getActor(nextPos))
+			if (world.getActor(nextPos))
 			{
 				const Direction nextDir = nextPos - m_position;
 				const Vec2i leftPos = m_position + nextDir.left45();
 				const Vec2i rightPos = m_position + nextDir.right45();
 
-				if (s_world->isPassable(leftPos) && !s_world->getActor(leftPos))
+				if (world.isPassable(leftPos) && !world.getActor(leftPos))
 					setPosition(leftPos);
-				else if (s_world->isPassable(rightPos) && !s_world->getActor(rightPos))
+				else if (world.isPassable(rightPos) && !world.getActor(rightPos))
 					setPosition(rightPos);
 			}
 
 			else
 				setPosition(nextPos);
 
-			s_world->openDoor(m_position);
+			world.openDoor(m_position);
 		}
 	}
+
+	return ActionCost;
+}
+
+bool Actor::isIdle() const
+{
+	return !m_target && m_statusEffects.empty();
 }
 
 Inventory* Actor::getInventory()
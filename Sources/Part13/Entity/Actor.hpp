@@ -14,25 +14,35 @@ enum class StatusEffect
 class Actor : public Entity
 {
 public:
+	// Time an action takes at normal speed, a faster actor takes less
+	static constexpr int ActionCost = 100;
+	static constexpr int NormalSpeed = 100;
+
 	explicit Actor(const std::string& name);
 
 	std::string_view getName() const override;
 
-	bool isPlayer() const;
+	virtual bool isPlayer() const;
 	bool isDestroyed() const;
 	int getHp() const;
 	virtual int getMaxHp() const;
 	virtual int getAttack() const;
 	virtual int getDefense() const;
 	int getXp() const;
+	int getSightRange() const;
+	static int getMaxSightRange(); // Of every kind of actor
+	int getSpeed() const;
+	int getDelay(int cost) const; // Until the next action after one of the given cost
 
 	void takeDamage(int damage);
 	void restoreHp(int points);
-	virtual void attack(Actor& target);
+	// The world the actor lives in is passed to everything that acts on it
+	virtual void attack(World& world, Actor& target);
 
 	Actor* getTarget() const;
 	void setTarget(Actor* target);
-	void updateAi();
+	int updateAi(World& world); // Returns the cost of the action taken
+	bool isIdle() const; // No target to chase and no status effect to wear off
 
 	virtual Inventory* getInventory();
 	virtual Equipment* getEquipment();
@@ -47,6 +57,8 @@ public:
 	void load(std::istream& is) override;
 
 private:
+	friend class Schedule;
+
 	const std::string m_name;
 	const ActorData& m_data;
 
@@ -54,4 +66,5 @@ private:
 
 	Actor* m_target = nullptr;
 	std::vector<std::pair<StatusEffect, int>> m_statusEffects;
+	bool m_scheduled = false;
 };
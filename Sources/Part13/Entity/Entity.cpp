@@ -1,6 +1,11 @@
 #include "Entity.hpp"
+#include "Occupancy.hpp"
 
-World* Entity::s_world = nullptr;
+Entity::~Entity()
+{
+	if (m_occupancy)
+		m_occupancy->remove(*this);
+}
 
 char Entity::getChar() const
 {
@@ -42,8 +47,16 @@ Vec2i Entity::getPosition() const
 
 void Entity::setPosition(int x, int y)
 {
+	Occupancy* const occupancy = m_occupancy;
+
+	if (occupancy)
+		occupancy->remove(*this);
+
 	m_position.x = x;
 	m_position.y = y;
+
+	if (occupancy)
+		occupancy->add(*this);
 }
 
 void Entity::setPosition(const Vec2i& position)
@@ -65,8 +78,3 @@ void Entity::load(std::istream& is)
 {
 	deserialize(is, m_position);
 }
-
-void Entity::setWorld(World& world)
-{
-	s_world = &world;
-}
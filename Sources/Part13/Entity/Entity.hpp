@@ -8,11 +8,13 @@
 #include <string_view>
 
 class World;
+class Occupancy;
 
 class Entity : public Serializable
 {
 public:
-	virtual ~Entity() = default;
+	Entity() = default;
+	virtual ~Entity();
 
 	char getChar() const;
 	Color getColor() const;
@@ -29,12 +31,15 @@ public:
 	void save(std::ostream& os) override;
 	void load(std::istream& is) override;
 
-	static void setWorld(World& world);
-
 protected:
-	static World* s_world;
-
 	char m_ch;
 	Color m_color;
 	Vec2i m_position;
+
+private:
+	friend class Occupancy;
+
+	// Set while the entity lies on a level
+	Occupancy* m_occupancy = nullptr;
+	Entity* m_nextInCell = nullptr;
 };
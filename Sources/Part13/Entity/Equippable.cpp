@@ -47,7 +47,7 @@ int Equippable::getDefenseBonus() const
 	return m_equippableData.defenseBonus;
 }
 
-void Equippable::equip(Actor& actor)
+void Equippable::equip(World& world, Actor& actor)
 {
 	Equipment* equipment = actor.getEquipment();
 	Equippable* old = equipment->get(getSlot());
@@ -56,14 +56,14 @@ void Equippable::equip(Actor& actor)
 	{
 		// Remove
 		equipment->unequip(getSlot());
-		s_world->addMessage("you removed " + old->getTheName() + ".");
+		world.addMessage("you removed " + old->getTheName() + ".");
 	}
 
 	if (old != this)
 	{
 		// Equip
 		equipment->equip(this);
-		s_world->addMessage("you equipped " + getTheName() + ".");
+		world.addMessage("you equipped " + getTheName() + ".");
 	}
 
 	// HACK: clamp max hp
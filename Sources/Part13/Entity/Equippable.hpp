@@ -14,7 +14,7 @@ public:
 	int getAttackBonus() const;
 	int getDefenseBonus() const;
 
-	void equip(Actor& actor) override;
+	void equip(World& world, Actor& actor) override;
 
 private:
 	const EquippableData& m_equippableData;
@@ -50,44 +50,44 @@ void Item::setCount(int count)
 	m_count = count;
 }
 
-void Item::apply(Actor& actor)
+void Item::apply(World& world, Actor& actor)
 {
-	m_data.apply(*this, actor);
+	m_data.apply(*this, world, actor);
 }
 
-void Item::heal(Actor& actor)
+void Item::heal(World& world, Actor& actor)
 {
 	actor.restoreHp(actor.getMaxHp() / 2);
 
 	if (actor.isPlayer())
-		s_world->addMessage("you feel better.");
+		world.addMessage("you feel better.");
 	else
-		s_world->addMessage(actor.getTheName() + " looks better.");
+		world.addMessage(actor.getTheName() + " looks better.");
 
 	--m_count;
 }
 
-void Item::confuse(Actor& actor)
+void Item::confuse(World& world, Actor& actor)
 {
-	actor.addStatusEffect(StatusEffect::Confused, randomInt(5, 10));
+	actor.addStatusEffect(StatusEffect::Confused, world.getRng().getInt(5, 10));
 
 	if (actor.isPlayer())
-		s_world->addMessage("you're confused.");
+		world.addMessage("you're confused.");
 	else
-		s_world->addMessage(actor.getTheName() + " looks confused.");
+		world.addMessage(actor.getTheName() + " looks confused.");
 
 	--m_count;
 }
 
-void Item::equip(Actor& actor)
+void Item::equip(World& world, Actor& actor)
 {
 }
 
-void Item::throwAt(Actor& actor)
+void Item::throwAt(World& world, Actor& actor)
 {
 	if (getChar() == '!') // getType() == Potion
 	{
-		m_data.apply(*this, actor);
+		m_data.apply(*this, world, actor);
 		--m_count;
 	}
 }
@@ -24,13 +24,13 @@ public:
 	void setCount(int count);
 
 	// Apply functions
-	void apply(Actor& actor);
-	void heal(Actor& actor);
-	void confuse(Actor& actor);
+	void apply(World& world, Actor& actor);
+	void heal(World& world, Actor& actor);
+	void confuse(World& world, Actor& actor);
 
-	virtual void equip(Actor& actor);
+	virtual void equip(World& world, Actor& actor);
 
-	void throwAt(Actor& actor);
+	void throwAt(World& world, Actor& actor);
 
 	void save(std::ostream& os) override;
 	void load(std::istream& is) override;
@@ -49,5 +49,5 @@ struct ItemData
 	char ch;
 	Color color;
 	std::string description;
-	std::function<void(Item&, Actor&)> apply;
+	std::function<void(Item&, World&, Actor&)> apply;
 };
@@ -59,9 +59,14 @@ void Player::increaseDefense(int points)
 	m_defense += points;
 }
 
-void Player::attack(Actor& target)
+bool Player::isPlayer() const
 {
-	Actor::attack(target);
+	return true;
+}
+
+void Player::attack(World& world, Actor& target)
+{
+	Actor::attack(world, target);
 
 	if (target.isDestroyed())
 	{
@@ -69,13 +74,13 @@ void Player::attack(Actor& target)
 		const int xpToNextLevel = getXpToNextLevel();
 
 		m_xp += xp;
-		s_world->addMessage("you gain " + std::to_string(xp) + " experience points.");
+		world.addMessage("you gain " + std::to_string(xp) + " experience points.");
 
 		if (m_xp >= xpToNextLevel)
 		{
 			m_xp -= xpToNextLevel;
 			++m_level;
-			s_world->openLevelUpMenu();
+			world.openLevelUpMenu();
 		}
 	}
 }
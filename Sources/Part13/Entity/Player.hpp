@@ -19,7 +19,8 @@ public:
 	void increaseAttack(int points);
 	void increaseDefense(int points);
 
-	void attack(Actor& target) override;
+	bool isPlayer() const override;
+	void attack(World& world, Actor& target) override;
 	Inventory* getInventory() override;
 	Equipment* getEquipment() override;
 
@@ -1,7 +1,6 @@
 #include "Game.hpp"
 #include "Engine/OpenGL.hpp"
 #include "Engine/Console.hpp"
-#include "Engine/Rng.hpp"
 #include "Menu/MainMenu.hpp"
 #include "Menu/PauseMenu.hpp"
 #include "Menu/InventoryMenu.hpp"
@@ -21,6 +20,9 @@ namespace
 
 	void removeSave()
 	{
+		if (Savepath.empty())
+			return;
+
 		std::filesystem::remove(Savepath);
 
 #ifdef __EMSCRIPTEN__
@@ -49,15 +51,25 @@ extern "C"
 	}
 }
 
-Game::Game(SDL_Window& window, Console& console)
+Game::Game(SDL_Window* window, Console& console, std::string savePath)
 	: m_window(window)
 	, m_console(console)
-	, m_renderer(console.getAtlas())
 {
-	glClearColor(0.f, 0.f, 0.f, 1.f);
+	if (window)
+	{
+		m_renderer = std::make_unique<Renderer>(console.getAtlas());
+		glClearColor(0.f, 0.f, 0.f, 1.f);
+	}
+
+	else
+	{
+		const int width = console.getWidth() * console.getTileWidth();
+		const int height = console.getHeight() * console.getTileHeight();
+		m_softwareRenderer = std::make_unique<SoftwareRenderer>(console.getAtlas(), width, height);
+	}
 
 	TheGame = this;
-	Savepath = "Part13/Savefile";
+	Savepath = std::move(savePath);
 
 #ifdef __EMSCRIPTEN__
 	EM_ASM(
@@ -74,16 +86,74 @@ Game::Game(SDL_Window& window, Console& console)
 #endif
 }
 
+Game::~Game()
+{
+	writeJournal();
+}
+
 bool Game::isRunning() const
 {
 	return m_running;
 }
 
+bool Game::isIdle() const
+{
+	// Monsters act in the update after the player's turn
+	const bool pending = m_world && m_world->getGameState() == GameState::EnemyTurn;
+
+	return !m_redraw && !pending;
+}
+
 void Game::tick()
 {
 	processInput();
+
+	if (isIdle())
+	{
+		++m_numSkippedFrames;
+		return;
+	}
+
 	update();
 	render();
+
+	m_redraw = false;
+	++m_numFrames;
+}
+
+std::size_t Game::getNumFrames() const
+{
+	return m_numFrames;
+}
+
+std::size_t Game::getNumSkippedFrames() const
+{
+	return m_numSkippedFrames;
+}
+
+void Game::setRecording(std::string prefix)
+{
+	m_recordPrefix = std::move(prefix);
+}
+
+void Game::setTerminal(std::ostream& os)
+{
+	m_terminalRenderer = std::make_unique<TerminalRenderer>(os);
+}
+
+std::size_t Game::getNumTerminalBytes() const
+{
+	return m_numTerminalBytes;
+}
+
+void Game::setJournal(std::string path)
+{
+	m_journalPath = std::move(path);
+}
+
+void Game::setSeed(unsigned int seed)
+{
+	m_seed = seed;
 }
 
 World* Game::getWorld()
@@ -93,9 +163,18 @@ World* Game::getWorld()
 
 void Game::createWorld()
 {
-	Rng rng;
-	m_world = std::make_unique<World>(*this, m_console.getWidth(), m_console.getHeight());
-	m_world->createLevel(rng.getSeed());
+	writeJournal();
+
+	const unsigned int seed = m_seed ? *m_seed : std::random_device()();
+	m_world = std::make_unique<World>(*this, m_console.getWidth(), m_console.getHeight(), seed);
+
+	if (!m_journalPath.empty())
+	{
+		m_journal = std::make_unique<Journal>(m_world->getSeed(), m_console.getWidth(), m_console.getHeight());
+		m_world->setJournal(m_journal.get());
+	}
+
+	m_world->createLevel();
 	removeSave();
 }
 
@@ -105,13 +184,27 @@ void Game::loadSavefile()
 
 	if (!ifs)
 	{
-		std::cout << "Error: Unable to open savefile.\n";
+		std::cerr << "Error: Unable to open savefile.\n";
 		return;
 	}
 
+	// A loaded game cannot be replayed from its seed
+	writeJournal();
+
 	m_world = std::make_unique<World>(*this, m_console.getWidth(), m_console.getHeight());
 	m_world->load(ifs);
+
+	const bool loaded = static_cast<bool>(ifs);
 	ifs.close();
+
+	// Its maps would not match its entities, a new game starts instead and drops it
+	if (!loaded)
+	{
+		std::cerr << "Error: Incompatible savefile.\n";
+		createWorld();
+		return;
+	}
+
 	removeSave();
 }
 
@@ -127,8 +220,9 @@ void Game::openMenu(std::unique_ptr<Menu> menu)
 
 void Game::openMainMenu()
 {
-	const bool hasSavefile = std::filesystem::exists(Savepath);
+	const bool hasSavefile = !Savepath.empty() && std::filesystem::exists(Savepath);
 	m_menu = std::make_unique<MainMenu>(*this, hasSavefile);
+	m_redraw = true; // Also opened by the filesystem callbacks, outside of processInput()
 }
 
 void Game::openPauseMenu()
@@ -143,14 +237,18 @@ bool Game::isSaving()
 
 void Game::save(bool quit)
 {
-	if (m_world && m_world->getPlayerActor())
+	if (m_world && m_world->getPlayerActor() && !Savepath.empty())
 	{
-		std::filesystem::create_directory("Part13");
+		const std::filesystem::path directory = std::filesystem::path(Savepath).parent_path();
+
+		if (!directory.empty())
+			std::filesystem::create_directories(directory);
+
 		std::ofstream ofs(Savepath, std::ios::binary);
 
 		if (!ofs)
 		{
-			std::cout << "Error: Unable to create savefile.\n";
+			std::cerr << "Error: Unable to create savefile.\n";
 			return;
 		}
 
@@ -161,6 +259,7 @@ void Game::save(bool quit)
 
 	if (quit)
 	{
+		writeJournal();
 		m_world = nullptr;
 		m_menu = nullptr;
 	}
@@ -202,12 +301,34 @@ void Game::openInventory(SDL_Keycode key)
 	}
 }
 
+void Game::writeJournal()
+{
+	if (!m_journal)
+		return;
+
+	m_world->setJournal(nullptr);
+	m_journal->setChecksum(m_world->getChecksum());
+
+	std::ofstream ofs(m_journalPath, std::ios::binary);
+
+	if (ofs)
+		m_journal->save(ofs);
+	else
+		std::cerr << "Error: Unable to create journal.\n";
+
+	m_journal = nullptr;
+}
+
 void Game::processInput()
 {
 	SDL_Event event;
 
 	while (SDL_PollEvent(&event))
 	{
+		// Keys change the game, window events may have wiped the last frame
+		if (event.type == SDL_KEYDOWN || event.type == SDL_WINDOWEVENT)
+			m_redraw = true;
+
 		if (event.type == SDL_QUIT)
 		{
 			m_running = false;
@@ -339,12 +460,36 @@ void Game::update()
 	if (m_menu)
 		m_menu->draw(m_console);
 
-	m_renderer.setSprites(m_console.getSprites());
+	if (m_renderer)
+		m_renderer->setSprites(m_console.getSprites());
+	else
+		m_softwareRenderer->setSprites(m_console.getSprites());
 }
 
 void Game::render()
 {
-	glClear(GL_COLOR_BUFFER_BIT);
-	m_renderer.render(&m_window);
-	SDL_GL_SwapWindow(&m_window);
+	if (m_terminalRenderer)
+	{
+		m_terminalRenderer->render(m_console);
+		m_numTerminalBytes += m_terminalRenderer->getNumBytes();
+	}
+
+	if (m_renderer)
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+		m_renderer->render(m_window);
+		SDL_GL_SwapWindow(m_window);
+		return;
+	}
+
+	m_softwareRenderer->render();
+
+	if (!m_recordPrefix.empty())
+	{
+		std::string number = std::to_string(m_numFrames);
+		number.insert(0, 5 - std::min<std::size_t>(number.size(), 5), '0');
+
+		if (!m_softwareRenderer->savePng(m_recordPrefix + number + ".png"))
+			std::cerr << "Error: Unable to save frame " << number << ".\n";
+	}
 }
@@ -1,24 +1,49 @@
 #pragma once
 
 #include "Engine/Renderer.hpp"
+#include "Engine/SoftwareRenderer.hpp"
+#include "Engine/TerminalRenderer.hpp"
 #include "World.hpp"
 
+#include <optional>
+#include <string>
+
 class Console;
 
-class Game
+class Game : public MenuHost
 {
 public:
-	Game(SDL_Window& window, Console& console);
+	// Without a window, frames are drawn by the software renderer.
+	// An empty savePath neither offers to continue nor saves, nor removes any savefile.
+	Game(SDL_Window* window, Console& console, std::string savePath = "Part13/Savefile");
+	~Game(); // Writes the journal
 
 	bool isRunning() const;
+	bool isIdle() const; // No input arrived and nothing is pending, tick() would draw the same frame
 	void tick();
 
+	std::size_t getNumFrames() const;
+	std::size_t getNumSkippedFrames() const;
+
+	// Saves every frame drawn by the software renderer as prefix00000.png, prefix00001.png...
+	void setRecording(std::string prefix);
+
+	// Also draws every frame in a terminal with ANSI escape sequences
+	void setTerminal(std::ostream& os);
+	std::size_t getNumTerminalBytes() const; // Written so far
+
+	// Records the actions of each new game, written to path when the game ends, see Replay
+	void setJournal(std::string path);
+
+	// Every new game plays from seed instead of a random one, for reproducible runs
+	void setSeed(unsigned int seed);
+
 	World* getWorld();
 	void createWorld();
 	void loadSavefile();
 
-	void closeMenu();
-	void openMenu(std::unique_ptr<Menu> menu);
+	void closeMenu() override;
+	void openMenu(std::unique_ptr<Menu> menu) override;
 	void openMainMenu();
 	void openPauseMenu();
 	void openInventory(SDL_Keycode key);
@@ -30,13 +55,25 @@ private:
 	void processInput();
 	void update();
 	void render();
+	void writeJournal();
 
 private:
-	SDL_Window& m_window;
+	SDL_Window* m_window;
 	Console& m_console;
-	Renderer m_renderer;
+	std::unique_ptr<Renderer> m_renderer;
+	std::unique_ptr<SoftwareRenderer> m_softwareRenderer;
+	std::unique_ptr<TerminalRenderer> m_terminalRenderer;
+	std::string m_recordPrefix;
+	std::size_t m_numTerminalBytes = 0;
+	std::string m_journalPath;
+	std::optional<unsigned int> m_seed;
 	bool m_running = true;
+	bool m_redraw = true; // Something changed since the last frame
+
+	std::size_t m_numFrames = 0;
+	std::size_t m_numSkippedFrames = 0;
 
+	std::unique_ptr<Journal> m_journal = nullptr; // Outlives the world that records into it
 	std::unique_ptr<World> m_world = nullptr;
 	std::unique_ptr<Menu> m_menu = nullptr;
 };
@@ -25,6 +25,14 @@ Item* Inventory::at(std::size_t i)
 	return nullptr;
 }
 
+std::size_t Inventory::find(const Item& item) const
+{
+	const auto found = std::find_if(m_items.begin(), m_items.end(),
+		[&] (const auto& i) { return i.get() == &item; });
+
+	return found - m_items.begin();
+}
+
 bool Inventory::isEmpty() const
 {
 	return m_items.empty();
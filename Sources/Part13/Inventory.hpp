@@ -12,6 +12,7 @@ public:
 	std::size_t getMaxSize() const;
 	std::size_t getNumItems() const;
 	Item* at(std::size_t i);
+	std::size_t find(const Item& item) const; // getNumItems() when not packed
 
 	bool isEmpty() const;
 	bool isFull() const;
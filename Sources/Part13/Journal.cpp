@@ -0,0 +1,75 @@
+#include "Journal.hpp"
+
+Journal::Journal(unsigned int seed, int screenWidth, int screenHeight)
+	: m_seed(seed)
+	, m_screenWidth(screenWidth)
+	, m_screenHeight(screenHeight)
+{
+}
+
+unsigned int Journal::getSeed() const
+{
+	return m_seed;
+}
+
+int Journal::getScreenWidth() const
+{
+	return m_screenWidth;
+}
+
+int Journal::getScreenHeight() const
+{
+	return m_screenHeight;
+}
+
+void Journal::record(Action action, std::size_t slot, int x, int y)
+{
+	m_entries.push_back({ action, static_cast<std::uint8_t>(slot), static_cast<std::int16_t>(x), static_cast<std::int16_t>(y) });
+}
+
+const std::vector<Journal::Entry>& Journal::getEntries() const
+{
+	return m_entries;
+}
+
+std::uint64_t Journal::getChecksum() const
+{
+	return m_checksum;
+}
+
+void Journal::setChecksum(std::uint64_t checksum)
+{
+	m_checksum = checksum;
+}
+
+void Journal::save(std::ostream& os)
+{
+	serialize(os, Magic);
+	serialize(os, Version);
+	serialize(os, m_seed);
+	serialize(os, m_screenWidth);
+	serialize(os, m_screenHeight);
+	serialize(os, m_checksum);
+	serialize(os, m_entries);
+}
+
+void Journal::load(std::istream& is)
+{
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+
+	deserialize(is, magic);
+	deserialize(is, version);
+
+	if (magic != Magic || version != Version)
+	{
+		is.setstate(std::ios::failbit);
+		return;
+	}
+
+	deserialize(is, m_seed);
+	deserialize(is, m_screenWidth);
+	deserialize(is, m_screenHeight);
+	deserialize(is, m_checksum);
+	deserialize(is, m_entries);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Engine/Serializable.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// The actions the player took in a world, in order. Every random draw of a world comes
+// from its seed, so a world of the same seed and size taking them again plays the same game.
+class Journal : public Serializable
+{
+public:
+	enum class Action : std::uint8_t
+	{
+		Move,    // x, y: direction
+		Wait,
+		Use,     // slot: inventory slot
+		Drop,    // slot
+		Throw,   // slot, x, y: target
+		LevelUp, // slot: stat, see LevelUpMenu
+	};
+
+	struct Entry
+	{
+		Action action;
+		std::uint8_t slot;
+		std::int16_t x;
+		std::int16_t y;
+	};
+
+public:
+	Journal() = default;
+	Journal(unsigned int seed, int screenWidth, int screenHeight);
+
+	unsigned int getSeed() const;
+	int getScreenWidth() const;
+	int getScreenHeight() const;
+
+	void record(Action action, std::size_t slot = 0, int x = 0, int y = 0);
+	const std::vector<Entry>& getEntries() const;
+
+	// World::getChecksum() after the last entry
+	std::uint64_t getChecksum() const;
+	void setChecksum(std::uint64_t checksum);
+
+	// A file that is not a journal sets the failbit of is
+	void save(std::ostream& os) override;
+	void load(std::istream& is) override;
+
+private:
+	static constexpr std::uint32_t Magic = 0x4C4E524A; // "JRNL"
+	static constexpr std::uint32_t Version = 2; // 2: monsters act in order of time
+
+	unsigned int m_seed = 0;
+	int m_screenWidth = 0;
+	int m_screenHeight = 0;
+	std::uint64_t m_checksum = 0;
+	std::vector<Entry> m_entries; // 6 bytes each
+};
@@ -3,16 +3,29 @@
 #include "Entity/Player.hpp"
 #include "Entity/Equippable.hpp"
 
+#include <algorithm> // find_if, remove_if
+#include <functional> // mem_fn
+
+namespace
+{
+	// The spawn tables can change without moving the rooms
+	constexpr std::uint64_t DungeonStream = 0;
+	constexpr std::uint64_t SpawnStream = 1;
+}
+
 Actor* Level::createMap(int width, int height, unsigned int seed, int depth)
 {
 	map = std::make_unique<Map>(width, height);
-	explored.resize(width * height, false);
+	actorCells = Occupancy(width, height);
+	itemCells = Occupancy(width, height);
+	explored = BitGrid(width, height);
 
 	this->seed = seed;
 	this->depth = depth;
-	Rng rng(seed);
+	Rng dungeonRng(seed, DungeonStream);
+	Rng rng(seed, SpawnStream);
 
-	const auto rooms = generateDungeon(*map, rng);
+	const auto rooms = generateDungeon(*map, dungeonRng);
 
 	// Place entities
 	Actor* player = nullptr;
@@ -64,8 +77,7 @@ Actor* Level::createMap(int width, int height, unsigned int seed, int depth)
 			actor->getEquipment()->equip(static_cast<Equippable*>(weapon.get()));
 			actor->getInventory()->pack(std::move(weapon));
 			actor->setPosition(pos);
-			player = actor.get();
-			actors.push_back(std::move(actor));
+			player = addActor(std::move(actor));
 			placePlayerActor = false;
 		}
 
@@ -81,7 +93,7 @@ Actor* Level::createMap(int width, int height, unsigned int seed, int depth)
 				const auto& id = rng.pickOneWeighted(actorsTable);
 				auto actor = std::make_unique<Actor>(id);
 				actor->setPosition(positions[j]);
-				actors.push_back(std::move(actor));
+				addActor(std::move(actor));
 			}
 
 			// Place items
@@ -94,7 +106,7 @@ Actor* Level::createMap(int width, int height, unsigned int seed, int depth)
 				const auto& id = rng.pickOneWeighted(itemsTable);
 				auto item = Item::createItem(id);
 				item->setPosition(positions[j]);
-				items.push_back(std::move(item));
+				addItem(std::move(item));
 			}
 
 			// Place up/down stairs
@@ -130,6 +142,76 @@ void Level::placeStairs(const Stairs& stairs)
 {
 	map->at(stairs.position).ch = stairs.ch;
 	map->at(stairs.position).color = stairs.color;
+	map->at(stairs.position).dimColor = getDimColor(stairs.color);
+}
+
+Actor* Level::addActor(std::unique_ptr<Actor> actor)
+{
+	actorCells.add(*actor);
+	actors.push_back(std::move(actor));
+
+	return actors.back().get();
+}
+
+std::unique_ptr<Actor> Level::removeActor(Actor& actor)
+{
+	const auto found = std::find_if(actors.begin(), actors.end(),
+		[&] (const auto& a) { return a.get() == &actor; });
+
+	assert(found != actors.end());
+
+	auto result = std::move(*found);
+	actors.erase(found);
+	actorCells.remove(*result);
+
+	return result;
+}
+
+void Level::removeDestroyedActors()
+{
+	// Destroyed actors unlink themselves
+	actors.erase(std::remove_if(actors.begin(), actors.end(),
+		std::mem_fn(&Actor::isDestroyed)), actors.end());
+}
+
+Item* Level::addItem(Item::Ptr item)
+{
+	itemCells.add(*item);
+	items.push_back(std::move(item));
+
+	return items.back().get();
+}
+
+Item::Ptr Level::removeItem(Item& item)
+{
+	const auto found = std::find_if(items.begin(), items.end(),
+		[&] (const auto& i) { return i.get() == &item; });
+
+	assert(found != items.end());
+
+	auto result = std::move(*found);
+	items.erase(found);
+	itemCells.remove(*result);
+
+	return result;
+}
+
+Actor* Level::getActor(const Vec2i& position) const
+{
+	for (Entity* entity = actorCells.getFirst(position); entity; entity = Occupancy::getNext(*entity))
+	{
+		Actor* actor = static_cast<Actor*>(entity);
+
+		if (!actor->isDestroyed())
+			return actor;
+	}
+
+	return nullptr;
+}
+
+Item* Level::getItem(const Vec2i& position) const
+{
+	return static_cast<Item*>(itemCells.getFirst(position));
 }
 
 void Level::save(std::ostream& os)
@@ -165,37 +247,43 @@ void Level::load(std::istream& is)
 	deserialize(is, depth);
 
 	map = std::make_unique<Map>(width, height);
+	actorCells = Occupancy(width, height);
+	itemCells = Occupancy(width, height);
 
-	Rng rng(seed);
+	Rng rng(seed, DungeonStream);
 
 	generateDungeon(*map, rng);
 
 	std::size_t numActors;
 	deserialize(is, numActors);
 
-	actors.resize(numActors);
+	actors.reserve(numActors);
 	for (std::size_t i = 0; i < numActors; ++i)
 	{
 		std::string name;
 		deserialize(is, name);
+		std::unique_ptr<Actor> actor;
 		if (name == "you")
-			actors[i] = std::make_unique<Player>();
+			actor = std::make_unique<Player>();
 		else
-			actors[i] = std::make_unique<Actor>(name);
-		actors[i]->load(is);
+			actor = std::make_unique<Actor>(name);
+		actor->load(is);
+		addActor(std::move(actor));
 	}
 
 	std::size_t numItems;
 	deserialize(is, numItems);
 
-	items.resize(numItems);
+	items.reserve(numItems);
 	for (std::size_t i = 0; i < numItems; ++i)
 	{
 		std::string name;
 		deserialize(is, name);
-		items[i] = Item::createItem(name);
-		items[i]->load(is);
+		Item::Ptr item = Item::createItem(name);
+		item->load(is);
+		addItem(std::move(item));
 	}
 
+	explored = BitGrid(width, height);
 	deserialize(is, explored);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Map.hpp"
+#include "Occupancy.hpp"
 #include "Entity/Actor.hpp"
 #include "Entity/Item.hpp"
 #include "Engine/Serializable.hpp"
@@ -26,6 +27,17 @@ public:
 	int fromDepth(const std::vector<std::pair<int, int>>& table);
 	void placeStairs(const Stairs& stairs);
 
+	// Keep the occupancy grids in sync with the entity lists
+	Actor* addActor(std::unique_ptr<Actor> actor);
+	std::unique_ptr<Actor> removeActor(Actor& actor);
+	void removeDestroyedActors();
+
+	Item* addItem(Item::Ptr item);
+	Item::Ptr removeItem(Item& item);
+
+	Actor* getActor(const Vec2i& position) const; // Living actors only
+	Item* getItem(const Vec2i& position) const; // Oldest item on the cell
+
 	void save(std::ostream& os) override;
 	void load(std::istream& is) override;
 
@@ -33,8 +45,11 @@ public:
 	unsigned int seed = 0;
 	int depth = 1;
 	std::unique_ptr<Map> map = nullptr;
+	// Declared before the entities, which unlink themselves when destroyed
+	Occupancy actorCells;
+	Occupancy itemCells;
 	std::vector<std::unique_ptr<Actor>> actors;
 	std::vector<std::unique_ptr<Item>> items;
-	std::vector<bool> explored;
+	BitGrid explored;
 	std::vector<Stairs> stairs;
 };
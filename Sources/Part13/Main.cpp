@@ -1,9 +1,15 @@
 #include "Game.hpp"
 #include "Engine/OpenGL.hpp"
 #include "Engine/Console.hpp"
+#include "Engine/TerminalInput.hpp"
 
+#include <chrono>
+#include <cstdlib> // strtoul
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -29,19 +35,151 @@ void main_loop(void* arg)
 		game->tick();
 }
 
+struct Options
+{
+	bool headless = false;
+	bool terminal = false;
+	std::string keys;
+	std::string recordPrefix;
+	std::string journalPath;
+	std::string savePath = "Part13/Savefile";
+	bool hasSavePath = false; // Scripted runs leave the savefile alone unless given one
+	std::optional<unsigned int> seed;
+};
+
+#ifndef __EMSCRIPTEN__
+// Plays the keys one per frame without a window, for golden images and recordings
+void runHeadless(Console& console, const Options& options)
+{
+	std::size_t numFrames = 0;
+	std::size_t numTerminalBytes = 0;
+
+	{
+		Game game(nullptr, console, options.hasSavePath ? options.savePath : "");
+		game.setRecording(options.recordPrefix);
+		game.setJournal(options.journalPath);
+
+		if (options.seed)
+			game.setSeed(*options.seed);
+
+		if (options.terminal)
+			game.setTerminal(std::cout);
+
+		game.tick();
+
+		for (const char key : options.keys)
+		{
+			if (!game.isRunning())
+				break;
+
+			SDL_Event event{};
+			event.type = SDL_KEYDOWN;
+			event.key.keysym.sym = key == '\n' ? SDLK_RETURN : static_cast<SDL_Keycode>(key);
+			SDL_PushEvent(&event);
+
+			do
+				game.tick();
+			while (game.isRunning() && !game.isIdle());
+		}
+
+		numFrames = game.getNumFrames();
+		numTerminalBytes = game.getNumTerminalBytes();
+	}
+
+	// The terminal renderer is gone, these lines go below the console
+	std::cout << "Frames drawn: " << numFrames << '\n';
+
+	if (options.terminal && numFrames > 0)
+		std::cout << "Terminal bytes: " << numTerminalBytes << ", " << numTerminalBytes / numFrames << " per frame\n";
+}
+
+// Plays from the keyboard of the terminal the game is drawn in, until Ctrl+C
+void runTerminal(Console& console, const Options& options)
+{
+	TerminalInput input;
+
+	// Piped in, nothing to play with
+	if (!input.isOpen())
+	{
+		runHeadless(console, options);
+		return;
+	}
+
+	constexpr int idleTimeout = 250;
+
+	Game game(nullptr, console, options.savePath);
+	game.setJournal(options.journalPath);
+	game.setTerminal(std::cout);
+
+	if (options.seed)
+		game.setSeed(*options.seed);
+
+	while (game.isRunning())
+	{
+		if (game.isIdle())
+			input.wait(idleTimeout);
+
+		input.pushEvents();
+		game.tick();
+	}
+}
+#endif
+
 int main(int argc, char* argv[])
 {
-	SDL_Init(SDL_INIT_VIDEO);
+	// --headless [--terminal] [--keys KEYS] [--record PREFIX] [--journal PATH] [--seed N] [--save PATH]
+	// --terminal without --keys plays from the keyboard of the terminal, Ctrl+C saves and quits
+	Options options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+
+		if (arg == "--headless")
+			options.headless = true;
+		else if (arg == "--terminal")
+			options.headless = options.terminal = true;
+		else if (arg == "--keys" && i + 1 < argc)
+			options.keys = argv[++i];
+		else if (arg == "--record" && i + 1 < argc)
+			options.recordPrefix = argv[++i];
+		else if (arg == "--journal" && i + 1 < argc)
+			options.journalPath = argv[++i];
+		else if (arg == "--seed" && i + 1 < argc)
+			options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--save" && i + 1 < argc)
+		{
+			options.savePath = argv[++i];
+			options.hasSavePath = true;
+		}
+	}
+
+	SDL_Init(options.headless ? SDL_INIT_EVENTS : SDL_INIT_VIDEO);
 
-	TTF_Init();
-	TTF_Font* font = TTF_OpenFont("Fonts/RecMono-Casual.ttf", 20);
+	// The font is only opened when the glyph atlas has to be built again
+	const auto startupStart = std::chrono::steady_clock::now();
 
 	constexpr int consoleWidth = 80;
 	constexpr int consoleHeight = 30;
-	auto console = std::make_unique<Console>(*font, consoleWidth, consoleHeight);
+	auto console = std::make_unique<Console>("Fonts/RecMono-Casual.ttf", 20, "GlyphAtlas.cache", consoleWidth, consoleHeight);
 
-	TTF_CloseFont(font);
-	TTF_Quit();
+	// Not on stdout, where --terminal writes the frames
+	const std::chrono::duration<double, std::milli> startupTime = std::chrono::steady_clock::now() - startupStart;
+	std::cerr << "Console ready in " << startupTime.count() << " ms, "
+		<< (console->isAtlasCached() ? "warm glyph cache\n" : "cold glyph cache\n");
+
+#ifndef __EMSCRIPTEN__
+	if (options.headless)
+	{
+		if (options.terminal && options.keys.empty())
+			runTerminal(*console, options);
+		else
+			runHeadless(*console, options);
+
+		SDL_Quit();
+		return 0;
+	}
+#endif
 
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 
@@ -61,7 +199,11 @@ int main(int argc, char* argv[])
 	}
 #endif
 
-	Game game(*window, *console);
+	Game game(window, *console, options.savePath);
+	game.setJournal(options.journalPath);
+
+	if (options.seed)
+		game.setSeed(*options.seed);
 
 #ifdef __EMSCRIPTEN__
 	emscripten_set_beforeunload_callback(&game, beforeunload_callback);
@@ -70,8 +212,19 @@ int main(int argc, char* argv[])
 	constexpr int simulate_infinite_loop = 1;
 	emscripten_set_main_loop_arg(main_loop, &game, fps, simulate_infinite_loop);
 #else
+	// Still wake up now and then, so the loop never hangs on a missed event
+	constexpr Uint32 idleTimeout = 250;
+
 	while (game.isRunning())
+	{
+		// Sleep until an event arrives instead of repainting the same frame
+		if (game.isIdle())
+			SDL_WaitEventTimeout(nullptr, idleTimeout);
+
 		game.tick();
+	}
+
+	std::cout << "Frames drawn: " << game.getNumFrames() << ", skipped: " << game.getNumSkippedFrames() << '\n';
 #endif
 
 	SDL_GL_DeleteContext(glContext);
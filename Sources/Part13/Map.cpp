@@ -1,10 +1,14 @@
 #include "Map.hpp"
 #include "Engine/Rng.hpp"
 
+#include <algorithm> // min, max, clamp
+
 Map::Map(int width, int height)
 	: m_width(width)
 	, m_height(height)
 	, m_tiles(width * height)
+	, m_passable(width, height, false)
+	, m_opaque(width, height, true)
 {
 }
 
@@ -48,6 +52,96 @@ const Tile& Map::at(const Vec2i& position) const
 	return at(position.x, position.y);
 }
 
+void Map::setPassable(const Vec2i& position, bool passable)
+{
+	at(position).passable = passable;
+
+	if (m_passable.test(position) != passable)
+	{
+		m_passable.set(position, passable);
+		markDirty(position);
+	}
+}
+
+void Map::setTransparent(const Vec2i& position, bool transparent)
+{
+	at(position).transparent = transparent;
+
+	if (m_opaque.test(position) == transparent)
+	{
+		m_opaque.set(position, !transparent);
+		markDirty(position);
+	}
+}
+
+bool Map::isPassable(const Vec2i& position) const
+{
+	return m_passable.test(position);
+}
+
+bool Map::isOpaque(const Vec2i& position) const
+{
+	return m_opaque.test(position);
+}
+
+const BitGrid& Map::getPassable() const
+{
+	return m_passable;
+}
+
+const BitGrid& Map::getOpaque() const
+{
+	return m_opaque;
+}
+
+unsigned int Map::getRevision() const
+{
+	return m_revision;
+}
+
+bool Map::isDirtyWithin(const Vec2i& center, int radius) const
+{
+	if (!m_dirty)
+		return false;
+
+	// Closest point of the dirty box to the center
+	const Vec2i closest(std::clamp(center.x, m_dirtyMin.x, m_dirtyMax.x), std::clamp(center.y, m_dirtyMin.y, m_dirtyMax.y));
+
+	return (closest - center).lengthSquared() <= radius * radius;
+}
+
+void Map::clearDirtyRegion()
+{
+	m_dirty = false;
+}
+
+void Map::markDirty(const Vec2i& position)
+{
+	++m_revision;
+
+	if (!m_dirty)
+	{
+		m_dirtyMin = position;
+		m_dirtyMax = position;
+		m_dirty = true;
+	}
+
+	else
+	{
+		m_dirtyMin = { std::min(m_dirtyMin.x, position.x), std::min(m_dirtyMin.y, position.y) };
+		m_dirtyMax = { std::max(m_dirtyMax.x, position.x), std::max(m_dirtyMax.y, position.y) };
+	}
+}
+
+Color getDimColor(Color color)
+{
+	color.r /= 5;
+	color.g /= 5;
+	color.b /= 5;
+
+	return color;
+}
+
 std::vector<Room> generateDungeon(Map& map, Rng& rng)
 {
 	// Credit: https://gist.github.com/munificent/b1bcd969063da3e6c298be070a22b604
@@ -126,22 +220,24 @@ std::vector<Room> generateDungeon(Map& map, Rng& rng)
 			{
 			case '#':
 				tile.color = 0x6D758D;
-				tile.passable = false;
-				tile.transparent = false;
+				map.setPassable({ x, y }, false);
+				map.setTransparent({ x, y }, false);
 				break;
 
 			case '.':
 				tile.color = 0x333941;
-				tile.passable = true;
-				tile.transparent = true;
+				map.setPassable({ x, y }, true);
+				map.setTransparent({ x, y }, true);
 				break;
 
 			case '+':
 				tile.color = 0x71413B;
-				tile.passable = true;
-				tile.transparent = false;
+				map.setPassable({ x, y }, true);
+				map.setTransparent({ x, y }, false);
 				break;
 			}
+
+			tile.dimColor = getDimColor(tile.color);
 		}
 
 	return rooms;
@@ -2,6 +2,7 @@
 
 #include "Engine/Color.hpp"
 #include "Engine/Vector2.hpp"
+#include "Engine/BitGrid.hpp"
 
 #include <vector>
 
@@ -9,10 +10,13 @@ struct Tile
 {
 	char ch = ' ';
 	Color color = 0xFFFFFF;
+	Color dimColor = 0x333333; // Explored but out of sight, see getDimColor()
 	bool passable = false;
 	bool transparent = false;
 };
 
+Color getDimColor(Color color);
+
 class Map
 {
 public:
@@ -30,10 +34,37 @@ public:
 	Tile& at(const Vec2i& position);
 	const Tile& at(const Vec2i& position) const;
 
+	// Keep the tile and the bitplanes in sync
+	void setPassable(const Vec2i& position, bool passable);
+	void setTransparent(const Vec2i& position, bool transparent);
+
+	bool isPassable(const Vec2i& position) const;
+	bool isOpaque(const Vec2i& position) const;
+
+	// One bit per cell, for the Fov and pathing hot loops
+	const BitGrid& getPassable() const;
+	const BitGrid& getOpaque() const;
+
+	// Bumped whenever passability or opacity changes
+	unsigned int getRevision() const;
+
+	// Bounding box of the changes since the last clearDirtyRegion()
+	bool isDirtyWithin(const Vec2i& center, int radius) const;
+	void clearDirtyRegion();
+
+private:
+	void markDirty(const Vec2i& position);
+
 private:
 	int m_width;
 	int m_height;
 	std::vector<Tile> m_tiles;
+	BitGrid m_passable;
+	BitGrid m_opaque;
+	unsigned int m_revision = 0;
+	Vec2i m_dirtyMin;
+	Vec2i m_dirtyMax;
+	bool m_dirty = false;
 };
 
 class Rng;
@@ -75,15 +75,12 @@ void InventoryMenu::activateButton()
 	{
 		Item* item = m_inventory.at(m_selectedItem);
 		m_world.useItem(*item);
-
-		if (item->getCount() == 0)
-			m_inventory.unpack(m_selectedItem);
 	}
 
 	else if (m_selectedButton == ButtonType::Drop)
 	{
-		Item::Ptr item = m_inventory.unpack(m_selectedItem);
-		m_world.dropItem(std::move(item));
+		Item* item = m_inventory.at(m_selectedItem);
+		m_world.dropItem(*item);
 	}
 
 	else if (m_selectedButton == ButtonType::Throw)
@@ -98,25 +98,6 @@ void LevelUpMenu::activate()
 	if (!hasSelection())
 		return;
 
-	auto* player = static_cast<Player*>(m_world.getPlayerActor());
-
-	switch (m_selected)
-	{
-	case 0:
-		player->increaseMaxHp(20);
-		m_world.addMessage("you become healthier.");
-		break;
-
-	case 1:
-		player->increaseAttack(1);
-		m_world.addMessage("you become stronger.");
-		break;
-
-	case 2:
-		player->increaseDefense(1);
-		m_world.addMessage("you become more agile.");
-		break;
-	}
-
+	m_world.levelUp(m_selected);
 	m_world.closeMenu();
 }
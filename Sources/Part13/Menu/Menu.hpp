@@ -2,6 +2,8 @@
 
 #include <SDL2/SDL.h>
 
+#include <memory>
+
 class Console;
 
 class Menu
@@ -12,3 +14,13 @@ public:
 	virtual void handleKeys(SDL_Keycode key) = 0;
 	virtual void draw(Console& console) = 0;
 };
+
+// Shows the menus the world opens, the game or anything driving a world without it
+class MenuHost
+{
+public:
+	virtual ~MenuHost() = default;
+
+	virtual void openMenu(std::unique_ptr<Menu> menu) = 0;
+	virtual void closeMenu() = 0;
+};
@@ -8,46 +8,46 @@ namespace
 	{
 		return (value > 0) - (value < 0);
 	}
+}
 
-	std::vector<Vec2i> plotLine(const Vec2i& start, const Vec2i& end)
-	{
-		const Vec2i delta = end - start;
+std::vector<Vec2i> plotLine(const Vec2i& start, const Vec2i& end)
+{
+	const Vec2i delta = end - start;
 
-		Vec2i primaryStep(sign(delta.x), 0);
-		Vec2i secondaryStep(0, sign(delta.y));
+	Vec2i primaryStep(sign(delta.x), 0);
+	Vec2i secondaryStep(0, sign(delta.y));
 
-		int primary = std::abs(delta.x);
-		int secondary = std::abs(delta.y);
+	int primary = std::abs(delta.x);
+	int secondary = std::abs(delta.y);
 
-		if (secondary > primary)
-		{
-			std::swap(primary, secondary);
-			std::swap(primaryStep, secondaryStep);
-		}
+	if (secondary > primary)
+	{
+		std::swap(primary, secondary);
+		std::swap(primaryStep, secondaryStep);
+	}
 
-		std::vector<Vec2i> line;
-		Vec2i current = start;
-		int error = 0;
+	std::vector<Vec2i> line;
+	Vec2i current = start;
+	int error = 0;
 
-		while (true)
-		{
-			line.emplace_back(current);
+	while (true)
+	{
+		line.emplace_back(current);
 
-			if (current == end)
-				break;
+		if (current == end)
+			break;
 
-			current += primaryStep;
-			error += secondary;
+		current += primaryStep;
+		error += secondary;
 
-			if (error * 2 >= primary)
-			{
-				current += secondaryStep;
-				error -= primary;
-			}
+		if (error * 2 >= primary)
+		{
+			current += secondaryStep;
+			error -= primary;
 		}
-
-		return line;
 	}
+
+	return line;
 }
 
 TargetingMenu::TargetingMenu(World& world, Actor& actor, Item& item)
@@ -31,3 +31,6 @@ private:
 	Vec2i m_cursor;
 	std::vector<Vec2i> m_path;
 };
+
+// The cells a thrown item flies over, start and end included
+std::vector<Vec2i> plotLine(const Vec2i& start, const Vec2i& end);
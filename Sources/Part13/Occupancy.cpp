@@ -0,0 +1,62 @@
+#include "Occupancy.hpp"
+#include "Entity/Entity.hpp"
+
+#include <cassert>
+
+Occupancy::Occupancy(int width, int height)
+	: m_width(width)
+	, m_height(height)
+	, m_heads(width * height, nullptr)
+{
+}
+
+void Occupancy::add(Entity& entity)
+{
+	assert(!entity.m_occupancy && isInBounds(entity.m_position));
+
+	Entity** link = &head(entity.m_position);
+
+	while (*link)
+		link = &(*link)->m_nextInCell;
+
+	*link = &entity;
+	entity.m_nextInCell = nullptr;
+	entity.m_occupancy = this;
+}
+
+void Occupancy::remove(Entity& entity)
+{
+	assert(entity.m_occupancy == this);
+
+	Entity** link = &head(entity.m_position);
+
+	while (*link != &entity)
+		link = &(*link)->m_nextInCell;
+
+	*link = entity.m_nextInCell;
+	entity.m_nextInCell = nullptr;
+	entity.m_occupancy = nullptr;
+}
+
+Entity* Occupancy::getFirst(const Vec2i& position) const
+{
+	if (!isInBounds(position))
+		return nullptr;
+
+	return m_heads[position.x + position.y * m_width];
+}
+
+Entity* Occupancy::getNext(const Entity& entity)
+{
+	return entity.m_nextInCell;
+}
+
+bool Occupancy::isInBounds(const Vec2i& position) const
+{
+	return position.x >= 0 && position.x < m_width && position.y >= 0 && position.y < m_height;
+}
+
+Entity*& Occupancy::head(const Vec2i& position)
+{
+	return m_heads[position.x + position.y * m_width];
+}
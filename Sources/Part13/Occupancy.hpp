@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Engine/Vector2.hpp"
+
+#include <vector>
+
+class Entity;
+
+// Entities of a level by cell. Every cell holds a short list threaded
+// through the entities themselves, oldest first, so finding what is
+// on a cell doesn't depend on how many entities the level has.
+// Entity::setPosition keeps the lists up to date.
+class Occupancy
+{
+public:
+	Occupancy() = default;
+	Occupancy(int width, int height);
+
+	void add(Entity& entity);
+	void remove(Entity& entity);
+
+	Entity* getFirst(const Vec2i& position) const;
+	static Entity* getNext(const Entity& entity);
+
+private:
+	bool isInBounds(const Vec2i& position) const;
+	Entity*& head(const Vec2i& position);
+
+private:
+	int m_width = 0;
+	int m_height = 0;
+	std::vector<Entity*> m_heads;
+};
@@ -0,0 +1,71 @@
+#include "Schedule.hpp"
+#include "Entity/Actor.hpp"
+
+#include <algorithm> // push_heap, pop_heap, make_heap, partition
+#include <cassert>
+
+bool Schedule::isEmpty() const
+{
+	return m_nodes.empty();
+}
+
+std::size_t Schedule::getSize() const
+{
+	return m_nodes.size();
+}
+
+bool Schedule::contains(const Actor& actor) const
+{
+	return actor.m_scheduled;
+}
+
+void Schedule::add(Actor& actor, std::uint64_t time)
+{
+	assert(!actor.m_scheduled);
+
+	m_nodes.push_back({ time, m_nextOrder++, &actor });
+	std::push_heap(m_nodes.begin(), m_nodes.end());
+	actor.m_scheduled = true;
+}
+
+std::uint64_t Schedule::getNextTime() const
+{
+	assert(!isEmpty());
+
+	return m_nodes.front().time;
+}
+
+Actor* Schedule::pop()
+{
+	assert(!isEmpty());
+
+	std::pop_heap(m_nodes.begin(), m_nodes.end());
+	Actor* actor = m_nodes.back().actor;
+	m_nodes.pop_back();
+	actor->m_scheduled = false;
+
+	return actor;
+}
+
+void Schedule::removeDestroyed()
+{
+	const auto removed = std::partition(m_nodes.begin(), m_nodes.end(),
+		[] (const Node& node) { return !node.actor->isDestroyed(); });
+
+	if (removed == m_nodes.end())
+		return;
+
+	for (auto it = removed; it != m_nodes.end(); ++it)
+		it->actor->m_scheduled = false;
+
+	m_nodes.erase(removed, m_nodes.end());
+	std::make_heap(m_nodes.begin(), m_nodes.end());
+}
+
+void Schedule::clear()
+{
+	for (auto& node : m_nodes)
+		node.actor->m_scheduled = false;
+
+	m_nodes.clear();
+}
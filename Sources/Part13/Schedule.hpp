@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Actor;
+
+// Actors of the current level that have something to do, by the time of
+// their next action. Actors without a target or a status effect are left
+// out until something wakes them, so sleeping monsters cost nothing per turn.
+// Actors due at the same time act in the order they were added.
+class Schedule
+{
+public:
+	bool isEmpty() const;
+	std::size_t getSize() const;
+	bool contains(const Actor& actor) const;
+
+	void add(Actor& actor, std::uint64_t time);
+	std::uint64_t getNextTime() const;
+	Actor* pop();
+
+	// Before the destroyed actors are freed
+	void removeDestroyed();
+	void clear();
+
+private:
+	struct Node
+	{
+		std::uint64_t time;
+		std::uint64_t order;
+		Actor* actor;
+
+		bool operator<(const Node& b) const
+		{
+			return time != b.time ? time > b.time : order > b.order;
+		}
+	};
+
+	std::vector<Node> m_nodes;
+	std::uint64_t m_nextOrder = 0;
+};
@@ -1,31 +1,33 @@
 #include "World.hpp"
-#include "Game.hpp"
 #include "Engine/Console.hpp"
-#include "Engine/Rng.hpp"
 #include "Entity/Player.hpp"
 #include "Menu/TargetingMenu.hpp"
 #include "Menu/LevelUpMenu.hpp"
 
-#include <algorithm> // find_if, remove_if
-#include <functional> // mem_fn
+#include <algorithm> // find_if
 
 namespace
 {
 	constexpr int PanelHeight = 5;
+
+	constexpr std::uint64_t GameStream = 0;
+	constexpr std::uint64_t LevelStream = 1;
 }
 
-World::World(Game& game, int screenWidth, int screenHeight)
-	: m_game(game)
+World::World(MenuHost& host, int screenWidth, int screenHeight, unsigned int seed, int numFovThreads)
+	: m_mapWidth(screenWidth)
+	, m_mapHeight(screenHeight - PanelHeight)
+	, m_numFovThreads(numFovThreads)
+	, m_host(host)
+	, m_rng(seed, GameStream)
+	, m_levelRng(seed, LevelStream)
 {
-	m_mapWidth = screenWidth;
-	m_mapHeight = screenHeight - PanelHeight;
-
-	Entity::setWorld(*this);
 }
 
-void World::createLevel(unsigned int seed)
+void World::createLevel()
 {
 	const int depth = m_level ? m_level->depth + 1 : 1;
+	const unsigned int seed = m_levelRng.next();
 
 	auto level = std::make_unique<Level>();
 	Actor* actor = level->createMap(m_mapWidth, m_mapHeight, seed, depth);
@@ -40,30 +42,52 @@ void World::setCurrentLevel(Level& level)
 {
 	if (m_level)
 	{
-		const auto found = std::find_if(m_actors->begin(), m_actors->end(),
-			[this] (const auto& a) { return a.get() == m_player; });
-
-		level.actors.push_back(std::move(*found));
-		m_actors->erase(found);
+		level.addActor(m_level->removeActor(*m_player));
 		m_fov->save(m_level->explored);
 	}
 
 	m_level = &level;
 	m_map = level.map.get();
+	m_layerValid = false;
 	m_actors = &level.actors;
 	m_items = &level.items;
 
+	// Monsters of the level left behind wait where they are
+	m_schedule.clear();
+
+	for (const auto& actor : level.actors)
+	{
+		if (actor.get() != m_player && !actor->isDestroyed())
+			wake(*actor);
+	}
+
+	const BitGrid::Reader blocksView = { &m_map->getOpaque() };
+	const BitGrid::Reader isPassable = { &m_map->getPassable() };
+
 	if (!m_fov)
-		m_fov = std::make_unique<Fov>(m_mapWidth, m_mapHeight, [this] (const Vec2i& pos) { return !m_map->at(pos).transparent; });
+		m_fov = std::make_unique<BasicFov<BitGrid::Reader>>(m_mapWidth, m_mapHeight, blocksView);
 
+	m_fov->setBlocksView(blocksView);
 	m_fov->load(level.explored);
 
 	if (!m_aStar)
 	{
-		m_aStar = std::make_unique<AStar>(m_mapWidth, m_mapHeight, [this] (const Vec2i& pos) { return m_map->at(pos).passable; });
+		m_aStar = std::make_unique<BasicAStar<BitGrid::Reader>>(m_mapWidth, m_mapHeight, isPassable);
 		m_aStar->setMaxCost(25);
+		m_aStar->setOpenSet(BasicAStar<BitGrid::Reader>::OpenSet::Buckets);
 	}
 
+	m_aStar->setPassable(isPassable);
+
+	if (!m_flowField)
+	{
+		m_flowField = std::make_unique<DijkstraMap>(m_mapWidth, m_mapHeight, [this] (const Vec2i& pos) { return m_map->isPassable(pos); });
+		m_flowField->setMaxCost(25);
+	}
+
+	// The flow field belongs to the previous map
+	m_flowField->invalidate();
+
 	if (!m_panel)
 	{
 		m_panel = std::make_unique<Panel>(0, m_mapHeight, m_mapWidth, PanelHeight);
@@ -76,17 +100,85 @@ GameState World::getGameState() const
 	return m_gameState;
 }
 
+unsigned int World::getSeed() const
+{
+	return m_rng.getSeed();
+}
+
+Rng& World::getRng()
+{
+	return m_rng;
+}
+
+std::uint64_t World::getChecksum() const
+{
+	std::uint64_t checksum = m_rng.getState() ^ (m_levelRng.getState() * 0x9E3779B97F4A7C15ULL);
+
+	if (m_player)
+	{
+		const Vec2i position = m_player->getPosition();
+		checksum ^= static_cast<std::uint64_t>(m_player->getHp()) << 48 ^ static_cast<std::uint64_t>(position.x) << 32 ^ static_cast<std::uint64_t>(position.y) << 16;
+	}
+
+	return checksum ^ static_cast<std::uint64_t>(m_level->depth);
+}
+
+void World::setJournal(Journal* journal)
+{
+	m_journal = journal;
+}
+
+// Same calls as the menus and the keys make
+void World::replay(const Journal::Entry& entry)
+{
+	Inventory* inventory = m_player->getInventory();
+
+	switch (entry.action)
+	{
+	case Journal::Action::Move:
+		movePlayer(entry.x, entry.y);
+		break;
+
+	case Journal::Action::Wait:
+		waitPlayer();
+		break;
+
+	case Journal::Action::Use:
+		useItem(*inventory->at(entry.slot));
+		break;
+
+	case Journal::Action::Drop:
+		dropItem(*inventory->at(entry.slot));
+		break;
+
+	case Journal::Action::Throw:
+	{
+		auto path = plotLine(m_player->getPosition(), Vec2i(entry.x, entry.y));
+		throwItem(*inventory->at(entry.slot), path);
+		break;
+	}
+
+	case Journal::Action::LevelUp:
+		levelUp(entry.slot);
+		closeMenu();
+		break;
+	}
+}
+
 void World::movePlayer(int dx, int dy)
 {
 	if (m_gameState != GameState::PlayerTurn)
 		return;
 
+	if (m_journal)
+		m_journal->record(Journal::Action::Move, 0, dx, dy);
+
 	if (m_player->hasStatusEffect(StatusEffect::Confused))
 	{
 		do
 		{
-			dx = randomInt(-1, 1);
-			dy = randomInt(-1, 1);
+			dx = m_rng.getInt(-1, 1);
+			dy = m_rng.getInt(-1, 1);
 		} while (dx == 0 && dy == 0);
 	}
 
@@ -96,24 +188,28 @@ void World::movePlayer(int dx, int dy)
 		return;
 
 	if (Actor* actor = getActor(newPos))
-		m_player->attack(*actor);
+		m_player->attack(*this, *actor);
 
-	else if (m_map->at(newPos).passable)
+	else if (m_map->isPassable(newPos))
 	{
 		m_player->move(dx, dy);
-		m_needsFovUpdate = true;
 
 		pickUpItem();
 		checkStairs();
 	}
 
-	m_gameState = GameState::EnemyTurn;
+	endPlayerTurn();
 }
 
 void World::waitPlayer()
 {
-	if (m_gameState == GameState::PlayerTurn)
-		m_gameState = GameState::EnemyTurn;
+	if (m_gameState != GameState::PlayerTurn)
+		return;
+
+	if (m_journal)
+		m_journal->record(Journal::Action::Wait);
+
+	endPlayerTurn();
 }
 
 void World::pickUpItem()
@@ -124,13 +220,8 @@ void World::pickUpItem()
 
 		if (!inventory->isFull())
 		{
-			const auto found = std::find_if(m_items->begin(), m_items->end(),
-				[&] (const auto& i) { return i.get() == item; });
-
-			m_panel->addMessage("you picked up " + (*found)->getAName() + ".");
-
-			inventory->pack(std::move(*found));
-			m_items->erase(found);
+			m_panel->addMessage("you picked up " + item->getAName() + ".");
+			inventory->pack(m_level->removeItem(*item));
 		}
 
 		else
@@ -161,9 +252,8 @@ void World::checkStairs()
 
 			else
 			{
-				Rng rng;
 				Level* prevLevel = m_level;
-				createLevel(rng.getSeed());
+				createLevel();
 				stairs.destination = m_level;
 
 				for (auto& stairs2 : m_level->stairs)
@@ -205,8 +295,6 @@ void World::ascend()
 					break;
 				}
 			}
-
-			m_needsFovUpdate = true;
 		}
 	}
 }
@@ -234,9 +322,8 @@ void World::descend()
 
 			else
 			{
-				Rng rng;
 				Level* prevLevel = m_level;
-				createLevel(rng.getSeed());
+				createLevel();
 				stairs.destination = m_level;
 
 				for (auto& stairs2 : m_level->stairs)
@@ -249,8 +336,6 @@ void World::descend()
 					}
 				}
 			}
-
-			m_needsFovUpdate = true;
 		}
 	}
 }
@@ -258,34 +343,47 @@ void World::descend()
 
 void World::useItem(Item& item)
 {
-	item.apply(*m_player);
-	m_gameState = GameState::EnemyTurn;
+	Inventory* inventory = m_player->getInventory();
+
+	if (m_journal)
+		m_journal->record(Journal::Action::Use, inventory->find(item));
+
+	item.apply(*this, *m_player);
+
+	if (item.getCount() == 0)
+		inventory->unpack(item);
+
+	endPlayerTurn();
 }
 
-void World::dropItem(Item::Ptr item)
+void World::dropItem(Item& itemToDrop)
 {
+	Inventory* inventory = m_player->getInventory();
+
+	if (m_journal)
+		m_journal->record(Journal::Action::Drop, inventory->find(itemToDrop));
+
+	auto item = inventory->unpack(itemToDrop);
 	Item* itemOnFloor = getItem(m_player->getPosition());
 
 	m_panel->addMessage("you dropped " + item->getAName() + ".");
 	item->setPosition(m_player->getPosition());
-	m_items->push_back(std::move(item));
+	m_level->addItem(std::move(item));
 
 	if (itemOnFloor)
 	{
-		const auto found = std::find_if(m_items->begin(), m_items->end(),
-			[&] (const auto& i) { return i.get() == itemOnFloor; });
-
-		m_panel->addMessage("you picked up " + (*found)->getAName() + ".");
-
-		m_player->getInventory()->pack(std::move(*found));
-		m_items->erase(found);
+		m_panel->addMessage("you picked up " + itemOnFloor->getAName() + ".");
+		inventory->pack(m_level->removeItem(*itemOnFloor));
 	}
 
-	m_gameState = GameState::EnemyTurn;
+	endPlayerTurn();
 }
 
 void World::throwItem(Item& item, std::vector<Vec2i>& path)
 {
+	if (m_journal)
+		m_journal->record(Journal::Action::Throw, m_player->getInventory()->find(item), path.back().x, path.back().y);
+
 	auto itemPtr = m_player->getInventory()->unpack(item);
 
 	for (std::size_t i = 1; i < path.size(); ++i)
@@ -294,14 +392,13 @@ void World::throwItem(Item& item, std::vector<Vec2i>& path)
 
 		if (Actor* actor = getActor(path[i]))
 		{
-			itemPtr->throwAt(*actor);
+			itemPtr->throwAt(*this, *actor);
+			wake(*actor);
 			break;
 		}
 
-		Tile& tile = m_map->at(path[i]);
-
-		// isWall
-		if (tile.ch == '#' || tile.ch == '+')
+		// Walls and closed doors stop the item
+		if (m_map->isOpaque(path[i]))
 		{
 			itemPtr->setPosition(path[i - 1]);
 			break;
@@ -313,30 +410,56 @@ void World::throwItem(Item& item, std::vector<Vec2i>& path)
 		if (itemPtr->getChar() == '!')
 			m_panel->addMessage("the flask shattered.");
 		else
-			m_items->push_back(std::move(itemPtr));
+			m_level->addItem(std::move(itemPtr));
 	}
 
-	m_gameState = GameState::EnemyTurn;
+	endPlayerTurn();
+}
+
+void World::levelUp(int stat)
+{
+	if (m_journal)
+		m_journal->record(Journal::Action::LevelUp, stat);
+
+	auto* player = static_cast<Player*>(m_player);
+
+	switch (stat)
+	{
+	case 0:
+		player->increaseMaxHp(20);
+		m_panel->addMessage("you become healthier.");
+		break;
+
+	case 1:
+		player->increaseAttack(1);
+		m_panel->addMessage("you become stronger.");
+		break;
+
+	case 2:
+		player->increaseDefense(1);
+		m_panel->addMessage("you become more agile.");
+		break;
+	}
 }
 
 void World::closeMenu()
 {
-	m_game.closeMenu();
+	m_host.closeMenu();
 }
 
 void World::openTargeting(Item& item)
 {
 	auto menu = std::make_unique<TargetingMenu>(*this, *m_player, item);
-	m_game.openMenu(std::move(menu));
+	m_host.openMenu(std::move(menu));
 }
 
 void World::openLevelUpMenu()
 {
 	auto menu = std::make_unique<LevelUpMenu>(*this);
-	m_game.openMenu(std::move(menu));
+	m_host.openMenu(std::move(menu));
 }
 
-void World::update(Console& console)
+void World::update()
 {
 	recomputeFov();
 
@@ -345,32 +468,46 @@ void World::update(Console& console)
 		m_player->finishTurn();
 		m_gameState = GameState::PlayerTurn;
 
-		for (auto& actor : *m_actors)
+		updateMonsterSight();
+
+		// Everyone due before the next action of the player, the player goes first on a tie
+		while (!m_schedule.isEmpty() && m_schedule.getNextTime() < m_playerTime)
 		{
-			if (actor.get() == m_player || actor->isDestroyed())
-				continue;
+			m_time = m_schedule.getNextTime();
+			Actor* actor = m_schedule.pop();
 
-			if (!actor->getTarget() && m_fov->isVisible(actor->getPosition()))
-				actor->setTarget(m_player);
+			if (actor->isDestroyed())
+				continue;
 
-			actor->updateAi();
+			const int cost = actor->updateAi(*this);
 			actor->finishTurn();
 
+			// Asleep until something wakes it again
+			if (!actor->isIdle())
+				m_schedule.add(*actor, m_time + actor->getDelay(cost));
+
 			if (m_player->isDestroyed())
 			{
 				m_gameState = GameState::PlayerDead;
+				m_deathCause = actor->getName();
 				m_player = nullptr;
 				m_panel->setPlayer(nullptr);
-				m_game.closeMenu(); // Close level up menu if you leveled up this turn.
+				m_host.closeMenu(); // Close level up menu if you leveled up this turn.
 				break;
 			}
 		}
 
+		m_time = m_playerTime;
+
 		// Enemeies may have opened or closed doors.
 		recomputeFov();
 		removeWrecks();
 	}
+}
 
+void World::update(Console& console)
+{
+	update();
 	updateConsole(console);
 }
 
@@ -381,7 +518,7 @@ bool World::isInBounds(const Vec2i& position) const
 
 bool World::isPassable(const Vec2i& position) const
 {
-	return m_map->isInBounds(position) && m_map->at(position).passable;
+	return m_map->isInBounds(position) && m_map->isPassable(position);
 }
 
 std::vector<Vec2i> World::findPath(const Vec2i& start, const Vec2i& target)
@@ -389,6 +526,26 @@ std::vector<Vec2i> World::findPath(const Vec2i& start, const Vec2i& target)
 	return m_aStar->findPath(start, target);
 }
 
+Vec2i World::getNextStep(const Vec2i& position, const Vec2i& target)
+{
+	// Every monster chases the player, so they all share a single distance field.
+	// It only needs to be rebuilt when the player moves (doors never change passability).
+	if (m_player && target == m_player->getPosition())
+	{
+		if (!m_flowField->isValid() || m_flowField->getGoal() != target)
+			m_flowField->compute(target);
+
+		return m_flowField->getNextStep(position);
+	}
+
+	const auto path = findPath(target, position);
+
+	if (path.size() > 1)
+		return path[1];
+
+	return position;
+}
+
 Actor* World::getPlayerActor() const
 {
 	return m_player;
@@ -396,46 +553,50 @@ Actor* World::getPlayerActor() const
 
 Actor* World::getActor(const Vec2i& position)
 {
-	const auto found = std::find_if(m_actors->begin(), m_actors->end(),
-		[&] (const auto& a) { return a->getPosition() == position && !a->isDestroyed(); });
+	return m_level->getActor(position);
+}
 
-	if (found != m_actors->end())
-		return found->get();
+Item* World::getItem(const Vec2i& position)
+{
+	return m_level->getItem(position);
+}
 
-	return nullptr;
+const Level& World::getLevel() const
+{
+	return *m_level;
 }
 
-Item* World::getItem(const Vec2i& position)
+Level& World::getLevel()
 {
-	const auto found = std::find_if(m_items->begin(), m_items->end(),
-		[&] (const auto& i) { return i->getPosition() == position; });
+	return *m_level;
+}
 
-	if (found != m_items->end())
-		return found->get();
+bool World::isVisible(const Vec2i& position) const
+{
+	return m_fov->isVisible(position);
+}
 
-	return nullptr;
+bool World::isExplored(const Vec2i& position) const
+{
+	return m_fov->isExplored(position);
 }
 
-void World::openDoor(const Vec2i& position)
+std::string_view World::getDeathCause() const
 {
-	Tile& tile = m_map->at(position);
+	return m_deathCause;
+}
 
-	if (tile.ch == '+' && !tile.transparent)
-	{
-		tile.transparent = true;
-		m_needsFovUpdate = true;
-	}
+// The Fov picks up the map revision, see recomputeFov()
+void World::openDoor(const Vec2i& position)
+{
+	if (m_map->at(position).ch == '+')
+		m_map->setTransparent(position, true);
 }
 
 void World::closeDoor(const Vec2i& position)
 {
-	Tile& tile = m_map->at(position);
-
-	if (tile.ch == '+' && tile.transparent)
-	{
-		tile.transparent = false;
-		m_needsFovUpdate = true;
-	}
+	if (m_map->at(position).ch == '+')
+		m_map->setTransparent(position, false);
 }
 
 void World::addMessage(std::string&& message)
@@ -453,6 +614,9 @@ void World::save(std::ostream& os)
 	// TODO: Badly structured because of compatibility for the previous tutorials,
 	//       Need to fix Map and Fov classes.
 
+	serialize(os, m_saveMagic);
+	serialize(os, m_saveVersion);
+
 	const std::size_t numLevels = m_levels.size();
 	serialize(os, numLevels);
 
@@ -475,6 +639,10 @@ void World::save(std::ostream& os)
 		}
 
 		m_levels[i]->save(os);
+
+		// The explored grid was swapped out of the Fov, give it back
+		if (m_levels[i].get() == m_level)
+			m_fov->load(m_levels[i]->explored);
 	}
 
 	// Serialize stairs
@@ -520,6 +688,18 @@ void World::save(std::ostream& os)
 
 void World::load(std::istream& is)
 {
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+
+	deserialize(is, magic);
+	deserialize(is, version);
+
+	if (magic != m_saveMagic || version != m_saveVersion)
+	{
+		is.setstate(std::ios::failbit);
+		return;
+	}
+
 	std::size_t numLevels;
 	deserialize(is, numLevels);
 
@@ -561,7 +741,6 @@ void World::load(std::istream& is)
 	deserialize(is, playerId);
 
 	m_player = m_levels[levelId]->actors[playerId].get();
-	setCurrentLevel(*m_levels[levelId]);
 
 	for (auto& level : m_levels)
 		for (auto& actor : level->actors)
@@ -573,53 +752,221 @@ void World::load(std::istream& is)
 				actor->setTarget(m_player);
 		}
 
-	m_fov->load(m_levels[levelId]->explored);
+	// Wakes the monsters that had a target
+	setCurrentLevel(*m_levels[levelId]);
+
 	m_panel->load(is);
 }
 
 void World::recomputeFov()
 {
-	if (m_needsFovUpdate && m_player)
+	if (!m_player)
+		return;
+
+	const Vec2i position = m_player->getPosition();
+	const unsigned int revision = m_map->getRevision();
+
+	if (m_fovMap == m_map && m_fovPosition == position)
+	{
+		if (m_fovRevision == revision)
+			return;
+
+		// Tiles changed out of range can't change what the player sees
+		if (!m_map->isDirtyWithin(position, m_fovRange))
+		{
+			m_fovCache[m_fovCacheCurrent].revision = revision;
+			m_fovRevision = revision;
+			m_map->clearDirtyRegion();
+			++m_numFovSkips;
+			return;
+		}
+	}
+
+	const auto found = std::find_if(m_fovCache.begin(), m_fovCache.end(), [&] (const FovCacheEntry& entry)
+		{ return entry.map == m_map && entry.position == position && entry.revision == revision; });
+
+	if (found != m_fovCache.end())
+	{
+		m_fov->restore(found->visible);
+		m_fovCacheCurrent = found - m_fovCache.begin();
+		++m_numFovSkips;
+	}
+
+	else
 	{
 		m_fov->clear();
-		m_fov->compute(m_player->getPosition(), m_fovRange);
-		m_needsFovUpdate = false;
+		m_fov->compute(position, m_fovRange);
+		++m_numFovRecomputes;
+
+		// Oldest entry goes first
+		m_fovCacheCurrent = m_fovCacheNext;
+		m_fovCacheNext = (m_fovCacheNext + 1) % m_fovCache.size();
+		m_fovCache[m_fovCacheCurrent] = { m_map, position, revision, m_fov->getVisible() };
+	}
+
+	m_fovMap = m_map;
+	m_fovPosition = position;
+	m_fovRevision = revision;
+	m_map->clearDirtyRegion();
+}
+
+void World::updateMonsterSight()
+{
+	// Monsters notice the player with their own eyes, so a troll can be sneaked past
+	// while an orc waiting in the dark sees the player coming.
+	const Vec2i playerPos = m_player->getPosition();
+	const int maxRange = Actor::getMaxSightRange();
+
+	m_viewers.clear();
+	m_viewerActors.clear();
+
+	// Only the cells around the player, sleeping monsters elsewhere cost nothing
+	for (int y = playerPos.y - maxRange; y <= playerPos.y + maxRange; ++y)
+		for (int x = playerPos.x - maxRange; x <= playerPos.x + maxRange; ++x)
+			for (Entity* entity = m_level->actorCells.getFirst({ x, y }); entity; entity = Occupancy::getNext(*entity))
+			{
+				Actor* actor = static_cast<Actor*>(entity);
+
+				if (actor == m_player || actor->isDestroyed() || actor->getTarget())
+					continue;
+
+				const int range = actor->getSightRange();
+
+				// Too far away to see the player whatever is in between
+				if ((actor->getPosition() - playerPos).lengthSquared() > range * range)
+					continue;
+
+				m_viewers.push_back({ actor->getPosition(), range });
+				m_viewerActors.push_back(actor);
+			}
+
+	if (m_viewers.empty())
+		return;
+
+	if (!m_monsterFov)
+		m_monsterFov = std::make_unique<FovBatch>(m_numFovThreads);
+
+	m_monsterFov->compute(m_map->getOpaque(), m_viewers);
+
+	for (std::size_t i = 0; i < m_viewerActors.size(); ++i)
+	{
+		if (m_monsterFov->isVisible(i, playerPos))
+		{
+			m_viewerActors[i]->setTarget(m_player);
+			wake(*m_viewerActors[i]);
+		}
 	}
 }
 
+std::size_t World::getNumFovRecomputes() const
+{
+	return m_numFovRecomputes;
+}
+
+std::size_t World::getNumFovSkips() const
+{
+	return m_numFovSkips;
+}
+
+std::size_t World::getNumAwake() const
+{
+	return m_schedule.getSize();
+}
+
+void World::endPlayerTurn(int cost)
+{
+	m_playerTime = m_time + m_player->getDelay(cost);
+	m_gameState = GameState::EnemyTurn;
+}
+
+// Acts in the current enemy turn
+void World::wake(Actor& actor)
+{
+	if (!m_schedule.contains(actor) && !actor.isIdle())
+		m_schedule.add(actor, m_time);
+}
+
 void World::removeWrecks()
 {
 	if (m_removeWrecks)
 	{
-		m_actors->erase(std::remove_if(m_actors->begin(), m_actors->end(),
-			std::mem_fn(&Actor::isDestroyed)), m_actors->end());
+		m_schedule.removeDestroyed();
+		m_level->removeDestroyedActors();
 
 		m_removeWrecks = false;
 	}
 }
 
-void World::updateConsole(Console& console)
+void World::updateMapLayer()
 {
-	// Draw map
-	if (m_map)
+	const BitGrid& visible = m_fov->getVisible();
+	const BitGrid& explored = m_fov->getExplored();
+
+	if (!m_layerValid || m_layerWizardVision != m_wizardVision)
 	{
-		for (int y = 0; y < m_map->getHeight(); ++y)
-			for (int x = 0; x < m_map->getWidth(); ++x)
-			{
-				const Tile& tile = m_map->at(x, y);
+		m_layerChars.resize(m_mapWidth * m_mapHeight);
+		m_layerColors.resize(m_mapWidth * m_mapHeight);
+		m_layerVisible = visible;
+		m_layerExplored = explored;
+		m_layerWizardVision = m_wizardVision;
+		m_layerValid = true;
 
-				if (m_wizardVision || m_fov->isVisible({ x, y }))
-					console.setChar(x, y, tile.ch, tile.color);
+		for (std::size_t i = 0; i < m_layerChars.size(); ++i)
+			setLayerCell(i);
 
-				else if (m_fov->isExplored({ x, y }))
-				{
-					Color color = tile.color;
-					color.r /= 5;
-					color.g /= 5;
-					color.b /= 5;
-					console.setChar(x, y, tile.ch, color);
-				}
-			}
+		return;
+	}
+
+	// Tiles don't change once generated, cells only change with their visible or explored bit
+	BitGrid::Word* layerVisible = m_layerVisible.getWords();
+	BitGrid::Word* layerExplored = m_layerExplored.getWords();
+
+	for (std::size_t w = 0; w < visible.getNumWords(); ++w)
+	{
+		BitGrid::Word changed = (visible.getWords()[w] ^ layerVisible[w]) | (explored.getWords()[w] ^ layerExplored[w]);
+
+		if (!changed)
+			continue;
+
+		layerVisible[w] = visible.getWords()[w];
+		layerExplored[w] = explored.getWords()[w];
+
+		for (; changed != 0; changed &= changed - 1)
+			setLayerCell(w * BitGrid::WordBits + BitGrid::countTrailingZeros(changed));
+	}
+}
+
+void World::setLayerCell(std::size_t i)
+{
+	const Tile& tile = m_map->at(static_cast<int>(i % m_mapWidth), static_cast<int>(i / m_mapWidth));
+
+	if (m_wizardVision || m_layerVisible.test(i))
+	{
+		m_layerChars[i] = tile.ch;
+		m_layerColors[i] = tile.color;
+	}
+
+	else if (m_layerExplored.test(i))
+	{
+		m_layerChars[i] = tile.ch;
+		m_layerColors[i] = tile.dimColor;
+	}
+
+	// Same as a cleared console cell
+	else
+	{
+		m_layerChars[i] = ' ';
+		m_layerColors[i] = 0xFFFFFF;
+	}
+}
+
+void World::updateConsole(Console& console)
+{
+	// Draw map, only the cells whose tile or Fov state changed are worked out again
+	if (m_map)
+	{
+		updateMapLayer();
+		console.setChars(0, 0, m_mapWidth, m_mapHeight, m_layerChars.data(), m_layerColors.data());
 	}
 
 	// Draw items
@@ -633,13 +980,7 @@ void World::updateConsole(Console& console)
 				console.setChar(pos.x, pos.y, item->getChar(), item->getColor());
 
 			else if (m_fov->isExplored(pos))
-			{
-				Color color = item->getColor();
-				color.r /= 5;
-				color.g /= 5;
-				color.b /= 5;
-				console.setChar(pos.x, pos.y, item->getChar(), color);
-			}
+				console.setChar(pos.x, pos.y, item->getChar(), getDimColor(item->getColor()));
 		}
 	}
 
@@ -3,17 +3,22 @@
 #include "Map.hpp"
 #include "Level.hpp"
 #include "Panel.hpp"
+#include "Journal.hpp"
+#include "Schedule.hpp"
 #include "Entity/Actor.hpp"
 #include "Entity/Item.hpp"
 #include "Menu/Menu.hpp"
 #include "Engine/Fov.hpp"
+#include "Engine/FovBatch.hpp"
 #include "Engine/AStar.hpp"
+#include "Engine/DijkstraMap.hpp"
+#include "Engine/Rng.hpp"
 #include "Engine/Serializable.hpp"
 
 #include <memory>
 #include <string>
+#include <string_view>
 
-class Game;
 class Console;
 
 enum class GameState
@@ -26,12 +31,22 @@ enum class GameState
 class World : public Serializable
 {
 public:
-	World(Game& game, int screenWidth, int screenHeight);
+	// Menus opened by the world are handed to host, nothing else is needed to play without a window.
+	// Every random draw of the world and its entities comes from seed, worlds share no state.
+	// Monster sight runs on numFovThreads threads, 0 uses every core. A world per thread wants 1.
+	World(MenuHost& host, int screenWidth, int screenHeight, unsigned int seed = std::random_device()(), int numFovThreads = 0);
 
-	void createLevel(unsigned int seed);
+	void createLevel();
 	void setCurrentLevel(Level& level);
 
 	GameState getGameState() const;
+	unsigned int getSeed() const;
+	Rng& getRng();
+	std::uint64_t getChecksum() const; // Differs as soon as a replay takes another turn than the game
+
+	// Records the actions of the player from now on, nullptr stops
+	void setJournal(Journal* journal);
+	void replay(const Journal::Entry& entry);
 
 	// Actions
 	void movePlayer(int dx, int dy);
@@ -44,55 +59,117 @@ public:
 	void descend();
 #endif
 
-	void useItem(Item& item);
-	void dropItem(Item::Ptr item);
+	void useItem(Item& item); // Removes it from the inventory when used up
+	void dropItem(Item& item);
 	void throwItem(Item& item, std::vector<Vec2i>& path);
+	void levelUp(int stat); // 0: constitution, 1: strength, 2: agility
 
 	void closeMenu();
 	void openTargeting(Item& item);
 	void openLevelUpMenu();
 
+	void update(); // Runs the enemy turn, if any
 	void update(Console& console);
 
 	bool isInBounds(const Vec2i& position) const;
 	bool isPassable(const Vec2i& position) const;
 	std::vector<Vec2i> findPath(const Vec2i& start, const Vec2i& target);
+	Vec2i getNextStep(const Vec2i& position, const Vec2i& target);
 
 	Actor* getPlayerActor() const;
 	Actor* getActor(const Vec2i& position);
 	Item* getItem(const Vec2i& position);
 
+	// What the player sees and remembers of the current level
+	const Level& getLevel() const;
+	Level& getLevel(); // For tools that stage a level, like the crowd benchmark
+	bool isVisible(const Vec2i& position) const;
+	bool isExplored(const Vec2i& position) const;
+	std::string_view getDeathCause() const; // Name of the killer, empty while the player lives
+
 	void openDoor(const Vec2i& position);
 	void closeDoor(const Vec2i& position);
 
 	void addMessage(std::string&& message);
 	void markRemoveWrecks();
 
+	// Fov updates that ran the shadowcasting versus the ones that were skipped or served from the cache
+	std::size_t getNumFovRecomputes() const;
+	std::size_t getNumFovSkips() const;
+	std::size_t getNumAwake() const; // Actors in the schedule
+
+	// A savefile of another format sets the failbit of is
 	void save(std::ostream& os) override;
 	void load(std::istream& is) override;
 
 private:
+	void endPlayerTurn(int cost = Actor::ActionCost);
+	void wake(Actor& actor);
 	void recomputeFov();
+	void updateMonsterSight();
 	void removeWrecks();
+	void updateMapLayer();
+	void setLayerCell(std::size_t i);
 	void updateConsole(Console& console);
 
+private:
+	struct FovCacheEntry
+	{
+		const Map* map = nullptr;
+		Vec2i position;
+		unsigned int revision = 0;
+		BitGrid visible;
+	};
+
 private:
 	static constexpr int m_fovRange = 10;
+	static constexpr std::size_t m_fovCacheSize = 16;
+	static constexpr std::uint32_t m_saveMagic = 0x45564153; // "SAVE"
+	static constexpr std::uint32_t m_saveVersion = 1; // The levels are generated again from their seeds
 	int m_mapWidth = 0;
 	int m_mapHeight = 0;
+	int m_numFovThreads = 0;
 
-	Game& m_game;
+	MenuHost& m_host;
+	Rng m_rng;
+	Rng m_levelRng; // Seeds of the new levels, they do not depend on how the game went
 	GameState m_gameState = GameState::PlayerTurn;
 	std::vector<std::unique_ptr<Level>> m_levels;
 	std::vector<std::unique_ptr<Actor>>* m_actors = nullptr;
 	std::vector<std::unique_ptr<Item>>* m_items = nullptr;
-	std::unique_ptr<Fov> m_fov = nullptr;
-	std::unique_ptr<AStar> m_aStar = nullptr;
+	// Both read the bitplanes of the current map directly
+	std::unique_ptr<BasicFov<BitGrid::Reader>> m_fov = nullptr;
+	std::unique_ptr<BasicAStar<BitGrid::Reader>> m_aStar = nullptr;
+	std::unique_ptr<DijkstraMap> m_flowField = nullptr; // Shared by all monsters chasing the player
+	std::unique_ptr<FovBatch> m_monsterFov = nullptr;
+	std::vector<FovBatch::Viewer> m_viewers;
+	std::vector<Actor*> m_viewerActors;
 	std::unique_ptr<Panel> m_panel = nullptr;
 	Level* m_level = nullptr;
 	Map* m_map = nullptr;
 	Actor* m_player = nullptr;
-	bool m_needsFovUpdate = true;
+	std::string m_deathCause;
+	Journal* m_journal = nullptr;
+	// Monsters act when they are due, the player when every one due before it has acted
+	Schedule m_schedule;
+	std::uint64_t m_time = 0;
+	std::uint64_t m_playerTime = 0;
+	// What the Fov was last computed for
+	const Map* m_fovMap = nullptr;
+	Vec2i m_fovPosition;
+	unsigned int m_fovRevision = 0;
+	std::vector<FovCacheEntry> m_fovCache = std::vector<FovCacheEntry>(m_fovCacheSize);
+	std::size_t m_fovCacheCurrent = 0;
+	std::size_t m_fovCacheNext = 0;
+	std::size_t m_numFovRecomputes = 0;
+	std::size_t m_numFovSkips = 0;
+	// The map as updateConsole() draws it, and the Fov it was drawn with
+	std::vector<char32_t> m_layerChars;
+	std::vector<Color> m_layerColors;
+	BitGrid m_layerVisible;
+	BitGrid m_layerExplored;
+	bool m_layerWizardVision = false;
+	bool m_layerValid = false;
 	bool m_removeWrecks = false;
 	bool m_wizardVision = false;
 };
@@ -0,0 +1,314 @@
+#include "Bot.hpp"
+#include "Inventory.hpp"
+#include "Equipment.hpp"
+#include "Entity/Equippable.hpp"
+#include "Menu/TargetingMenu.hpp"
+#include "Engine/Direction.hpp"
+
+#include <algorithm> // max
+#include <cstdlib> // abs
+#include <fstream>
+
+namespace
+{
+	constexpr Vec2i Nowhere(-1, -1);
+
+	int getScore(const Equippable& item)
+	{
+		return item.getMaxHpBonus() / 10 + item.getAttackBonus() + item.getDefenseBonus();
+	}
+
+	int getDistance(const Vec2i& a, const Vec2i& b)
+	{
+		return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+	}
+}
+
+Bot::Bot(int screenWidth, int screenHeight, unsigned int seed)
+	: m_screenWidth(screenWidth)
+	, m_screenHeight(screenHeight)
+	, m_world(*this, screenWidth, screenHeight, seed, 1) // Every game already has a thread of its own
+{
+	m_world.createLevel();
+}
+
+void Bot::play(std::size_t maxTurns)
+{
+	while (!isDead() && m_numTurns < maxTurns)
+	{
+		// Only the level up menu opens by itself, the stats are raised in turn
+		if (m_menu)
+		{
+			m_menu->handleKeys(static_cast<SDL_Keycode>(SDLK_a + m_numLevelUps++ % 3));
+			continue;
+		}
+
+		act();
+
+		if (m_world.getGameState() == GameState::PlayerTurn)
+			m_world.waitPlayer(); // Nothing to do
+
+		++m_numTurns;
+		m_world.update();
+		m_maxDepth = std::max(m_maxDepth, m_world.getLevel().depth);
+	}
+}
+
+void Bot::startJournal()
+{
+	m_journal = std::make_unique<Journal>(m_world.getSeed(), m_screenWidth, m_screenHeight);
+	m_world.setJournal(m_journal.get());
+}
+
+bool Bot::saveJournal(const std::string& path)
+{
+	std::ofstream ofs(path, std::ios::binary);
+
+	if (!m_journal || !ofs)
+		return false;
+
+	m_journal->setChecksum(m_world.getChecksum());
+	m_journal->save(ofs);
+
+	return true;
+}
+
+bool Bot::isDead() const
+{
+	return m_world.getGameState() == GameState::PlayerDead;
+}
+
+std::string_view Bot::getDeathCause() const
+{
+	return m_world.getDeathCause();
+}
+
+std::size_t Bot::getNumTurns() const
+{
+	return m_numTurns;
+}
+
+int Bot::getMaxDepth() const
+{
+	return m_maxDepth;
+}
+
+void Bot::openMenu(std::unique_ptr<Menu> menu)
+{
+	m_menu = std::move(menu);
+}
+
+void Bot::closeMenu()
+{
+	m_menu = nullptr;
+}
+
+void Bot::act()
+{
+	Actor& player = *m_world.getPlayerActor();
+
+	if (!heal(player) && !equip(player) && !fight(player))
+		explore(player);
+}
+
+bool Bot::heal(Actor& player)
+{
+	if (player.getHp() * 10 >= player.getMaxHp() * 4)
+		return false;
+
+	Item* potion = findItem(player, "potion of healing");
+	if (!potion)
+		return false;
+
+	m_world.useItem(*potion);
+	return true;
+}
+
+bool Bot::equip(Actor& player)
+{
+	Inventory* inventory = player.getInventory();
+	Equipment* equipment = player.getEquipment();
+
+	for (std::size_t i = 0; i < inventory->getNumItems(); ++i)
+	{
+		auto* item = dynamic_cast<Equippable*>(inventory->at(i));
+
+		if (!item || equipment->getEquippedSlot(*item) != Equipment::None)
+			continue;
+
+		const Equippable* current = equipment->get(item->getSlot());
+
+		if (!current || getScore(*item) > getScore(*current))
+		{
+			m_world.useItem(*item);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Bot::fight(Actor& player)
+{
+	const Vec2i position = player.getPosition();
+	const Actor* target = nullptr;
+	int targetDistance = 0;
+
+	for (const auto& actor : m_world.getLevel().actors)
+	{
+		if (actor.get() == &player || actor->isDestroyed() || !m_world.isVisible(actor->getPosition()))
+			continue;
+
+		const int distance = getDistance(position, actor->getPosition());
+
+		if (!target || distance < targetDistance)
+		{
+			target = actor.get();
+			targetDistance = distance;
+		}
+	}
+
+	if (!target)
+		return false;
+
+	if (targetDistance > 1 && confuse(player, *target))
+		return true;
+
+	// Moving into the target attacks it
+	const Vec2i next = targetDistance == 1 ? target->getPosition() : m_world.getNextStep(position, target->getPosition());
+
+	if (next == position)
+		return false;
+
+	step(player, next);
+	return true;
+}
+
+bool Bot::confuse(Actor& player, const Actor& target)
+{
+	if (target.getName() != "troll" || target.hasStatusEffect(StatusEffect::Confused))
+		return false;
+
+	Item* potion = findItem(player, "potion of confusion");
+	if (!potion)
+		return false;
+
+	auto path = plotLine(player.getPosition(), target.getPosition());
+
+	// The flask would shatter on anything in the way
+	for (std::size_t i = 1; i + 1 < path.size(); ++i)
+	{
+		if (m_world.getActor(path[i]) || m_world.getLevel().map->isOpaque(path[i]))
+			return false;
+	}
+
+	m_world.throwItem(*potion, path);
+	return true;
+}
+
+bool Bot::explore(Actor& player)
+{
+	const Level& level = m_world.getLevel();
+	const Map& map = *level.map;
+	const Vec2i start = player.getPosition();
+	const bool canPickUp = !player.getInventory()->isFull();
+
+	const auto index = [&] (const Vec2i& position) { return position.x + position.y * map.getWidth(); };
+
+	// Breadth first, the nearest goal wins
+	const auto search = [&] (const Vec2i& stairs, auto isGoal)
+	{
+		m_parents.assign(map.getWidth() * map.getHeight(), -1);
+		m_parents[index(start)] = index(start);
+		m_queue.assign(1, start);
+
+		for (std::size_t i = 0; i < m_queue.size(); ++i)
+		{
+			for (const auto& direction : Direction::All)
+			{
+				const Vec2i next = m_queue[i] + direction;
+
+				if (!map.isInBounds(next) || m_parents[index(next)] >= 0 || !isWalkable(next, stairs))
+					continue;
+
+				m_parents[index(next)] = index(m_queue[i]);
+
+				if (isGoal(next))
+				{
+					// Back to the cell next to the start
+					Vec2i position = next;
+
+					while (m_parents[index(position)] != index(start))
+					{
+						const int parent = m_parents[index(position)];
+						position = { parent % map.getWidth(), parent / map.getWidth() };
+					}
+
+					step(player, position);
+					return true;
+				}
+
+				m_queue.push_back(next);
+			}
+		}
+
+		return false;
+	};
+
+	const bool found = search(Nowhere, [&] (const Vec2i& position)
+	{
+		return !m_world.isExplored(position) || (canPickUp && m_world.getItem(position));
+	});
+
+	if (found)
+		return true;
+
+	// Nothing left to see, down the stairs
+	for (const auto& stairs : level.stairs)
+	{
+		if (stairs.ch == '>' && m_world.isExplored(stairs.position))
+			return search(stairs.position, [&] (const Vec2i& position) { return position == stairs.position; });
+	}
+
+	return false;
+}
+
+void Bot::step(Actor& player, const Vec2i& position)
+{
+	const Vec2i delta = position - player.getPosition();
+	m_world.movePlayer(delta.x, delta.y);
+}
+
+Item* Bot::findItem(Actor& player, std::string_view name) const
+{
+	Inventory* inventory = player.getInventory();
+
+	for (std::size_t i = 0; i < inventory->getNumItems(); ++i)
+	{
+		if (inventory->at(i)->getName() == name)
+			return inventory->at(i);
+	}
+
+	return nullptr;
+}
+
+// Unexplored cells are hoped to be floor, stairs are avoided unless taking them is the plan
+bool Bot::isWalkable(const Vec2i& position, const Vec2i& stairs) const
+{
+	if (!m_world.isExplored(position))
+		return true;
+
+	if (position == stairs)
+		return true;
+
+	if (!m_world.getLevel().map->isPassable(position))
+		return false;
+
+	for (const auto& s : m_world.getLevel().stairs)
+	{
+		if (s.position == position)
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "World.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Plays a whole game through the same World actions as the keyboard, without a window.
+// Heals when low, equips what it finds, confuses trolls from afar, fights what it sees,
+// then explores the level and takes the stairs down.
+class Bot : public MenuHost
+{
+public:
+	Bot(int screenWidth, int screenHeight, unsigned int seed);
+
+	// Until the player dies or maxTurns player turns have passed
+	void play(std::size_t maxTurns);
+
+	// Records the game for Replay, call before play()
+	void startJournal();
+	bool saveJournal(const std::string& path);
+
+	bool isDead() const;
+	std::string_view getDeathCause() const;
+	std::size_t getNumTurns() const;
+	int getMaxDepth() const;
+
+	void openMenu(std::unique_ptr<Menu> menu) override;
+	void closeMenu() override;
+
+private:
+	void act();
+	bool heal(Actor& player);
+	bool equip(Actor& player);
+	bool fight(Actor& player);
+	bool confuse(Actor& player, const Actor& target);
+	bool explore(Actor& player);
+	void step(Actor& player, const Vec2i& position);
+
+	Item* findItem(Actor& player, std::string_view name) const;
+	bool isWalkable(const Vec2i& position, const Vec2i& stairs) const;
+
+private:
+	int m_screenWidth;
+	int m_screenHeight;
+	std::unique_ptr<Journal> m_journal = nullptr; // Outlives the world that records into it
+	World m_world;
+	std::unique_ptr<Menu> m_menu = nullptr; // Destroyed before the world it refers to
+	std::size_t m_numTurns = 0;
+	int m_maxDepth = 1;
+	int m_numLevelUps = 0;
+	std::vector<int> m_parents; // Breadth first search in explore()
+	std::vector<Vec2i> m_queue;
+};
@@ -0,0 +1,194 @@
+// Enemy turns of a level crowded with sleeping monsters. A few trolls chase the player,
+// who waits and is healed every turn, while the rest sleep out of sight. With the schedule
+// the time of a turn should not depend on how many are asleep.
+// Usage: Crowd [turns]
+
+#include "World.hpp"
+#include "Benchmarks/Benchmark.hpp"
+
+#include <algorithm> // max
+#include <cstdlib> // strtoul, abs
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr int ScreenWidth = 80;
+	constexpr int ScreenHeight = 30;
+	constexpr int NumAwake = 6;
+	constexpr unsigned int Seed = 2020;
+
+	class Host : public MenuHost
+	{
+	public:
+		void openMenu(std::unique_ptr<Menu> menu) override
+		{
+			m_menu = std::move(menu);
+		}
+
+		void closeMenu() override
+		{
+			m_menu = nullptr;
+		}
+
+	private:
+		std::unique_ptr<Menu> m_menu = nullptr;
+	};
+
+	// Trolls next to the player, orcs stacked on the floor out of sight of it
+	void populate(World& world, int numAsleep)
+	{
+		Level& level = world.getLevel();
+		const Vec2i playerPos = world.getPlayerActor()->getPosition();
+		const int maxRange = Actor::getMaxSightRange();
+
+		std::vector<Vec2i> near;
+		std::vector<Vec2i> far;
+
+		for (int y = 0; y < level.map->getHeight(); ++y)
+			for (int x = 0; x < level.map->getWidth(); ++x)
+			{
+				const Vec2i position(x, y);
+				const Vec2i delta = position - playerPos;
+
+				if (!level.map->isPassable(position) || level.getActor(position))
+					continue;
+
+				// Outside the square of cells World looks for monsters that could see the player
+				if (std::max(std::abs(delta.x), std::abs(delta.y)) > maxRange)
+					far.push_back(position);
+				else if (delta.lengthSquared() <= 9 && world.isVisible(position))
+					near.push_back(position);
+			}
+
+		const auto add = [&] (const std::string& name, const Vec2i& position)
+		{
+			auto actor = std::make_unique<Actor>(name);
+			actor->setPosition(position);
+			level.addActor(std::move(actor));
+		};
+
+		for (std::size_t i = 0; i < near.size() && i < NumAwake; ++i)
+			add("troll", near[i]);
+
+		for (int i = 0; i < numAsleep && !far.empty(); ++i)
+			add("orc", far[i % far.size()]);
+	}
+
+	// The enemy turn as World::update ran it before the schedule: every actor is visited,
+	// the ones in sight range look for the player, then every one with a target acts
+	class FlatTurn
+	{
+	public:
+		void run(World& world)
+		{
+			Actor& player = *world.getPlayerActor();
+			const Vec2i playerPos = player.getPosition();
+			auto& actors = world.getLevel().actors;
+
+			player.finishTurn();
+
+			m_viewers.clear();
+			m_viewerActors.clear();
+
+			for (const auto& actor : actors)
+			{
+				if (actor.get() == &player || actor->isDestroyed() || actor->getTarget())
+					continue;
+
+				const int range = actor->getSightRange();
+
+				if ((actor->getPosition() - playerPos).lengthSquared() > range * range)
+					continue;
+
+				m_viewers.push_back({ actor->getPosition(), range });
+				m_viewerActors.push_back(actor.get());
+			}
+
+			if (!m_viewers.empty())
+			{
+				m_fov.compute(world.getLevel().map->getOpaque(), m_viewers);
+
+				for (std::size_t i = 0; i < m_viewerActors.size(); ++i)
+				{
+					if (m_fov.isVisible(i, playerPos))
+						m_viewerActors[i]->setTarget(&player);
+				}
+			}
+
+			for (const auto& actor : actors)
+			{
+				if (actor.get() == &player || actor->isDestroyed())
+					continue;
+
+				actor->updateAi(world);
+				actor->finishTurn();
+			}
+		}
+
+	private:
+		FovBatch m_fov{ 1 };
+		std::vector<FovBatch::Viewer> m_viewers;
+		std::vector<Actor*> m_viewerActors;
+	};
+
+	// Two worlds populated alike, one plays its turns with the schedule, the other with the flat loop
+	void run(int numAsleep, std::size_t numTurns)
+	{
+		Host host;
+		World scheduled(host, ScreenWidth, ScreenHeight, Seed, 1);
+		World flat(host, ScreenWidth, ScreenHeight, Seed, 1);
+
+		for (World* world : { &scheduled, &flat })
+		{
+			world->createLevel();
+			world->update(); // The first frame
+			populate(*world, numAsleep);
+		}
+
+		const std::string label = std::to_string(scheduled.getLevel().actors.size()) + " actors, ";
+		std::size_t awake = 0;
+
+		{
+			Actor& player = *scheduled.getPlayerActor();
+			Benchmark::Timer timer;
+
+			for (std::size_t i = 0; i < numTurns; ++i)
+			{
+				player.restoreHp(player.getMaxHp());
+				scheduled.waitPlayer();
+				scheduled.update();
+				awake += scheduled.getNumAwake();
+			}
+
+			Benchmark::report(label + "scheduled", timer.getSeconds(), numTurns, "turn");
+		}
+
+		{
+			Actor& player = *flat.getPlayerActor();
+			FlatTurn turn;
+			Benchmark::Timer timer;
+
+			for (std::size_t i = 0; i < numTurns; ++i)
+			{
+				player.restoreHp(player.getMaxHp());
+				turn.run(flat);
+			}
+
+			Benchmark::report(label + "every actor visited", timer.getSeconds(), numTurns, "turn");
+		}
+
+		std::cout << "  " << static_cast<double>(awake) / numTurns << " awake on average\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t numTurns = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+
+	for (const int numAsleep : { 0, 1'000, 10'000, 100'000 })
+		run(numAsleep, numTurns);
+
+	return 0;
+}
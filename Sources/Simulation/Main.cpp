@@ -0,0 +1,145 @@
+// Plays many games with bots, one game per worker thread, to balance the spawn tables.
+// Usage: Simulation [games] [threads] [max turns per game] [journal prefix]
+// With 0 threads, the same games are played on 1, 2, 4... threads to measure the scaling.
+// With a journal prefix, game N is recorded to prefixN.journal for Replay.
+
+#include "Bot.hpp"
+
+#include <algorithm> // max
+#include <atomic>
+#include <chrono>
+#include <cstdlib> // strtoul
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Same size as the game, 80x30 console with the panel below the map
+	constexpr int ScreenWidth = 80;
+	constexpr int ScreenHeight = 30;
+
+	struct Results
+	{
+		std::size_t numGames = 0;
+		std::size_t numTurns = 0;
+		std::map<int, std::size_t> depths; // Deepest level reached
+		std::map<std::string, std::size_t> endings; // Killer, or "turn limit"
+		double seconds = 0.0;
+
+		void add(const Results& other)
+		{
+			numGames += other.numGames;
+			numTurns += other.numTurns;
+
+			for (const auto& [depth, count] : other.depths)
+				depths[depth] += count;
+
+			for (const auto& [ending, count] : other.endings)
+				endings[ending] += count;
+		}
+	};
+
+	// Worlds share no state, every thread plays its own games
+	Results play(std::size_t numGames, std::size_t numThreads, std::size_t maxTurns, const std::string& journalPrefix)
+	{
+		std::atomic<std::size_t> nextGame{ 0 };
+		std::mutex mutex;
+		Results results;
+
+		const auto work = [&]
+		{
+			Results local;
+
+			// The game number is the seed, a game plays the same on any thread
+			for (std::size_t game = nextGame++; game < numGames; game = nextGame++)
+			{
+				Bot bot(ScreenWidth, ScreenHeight, static_cast<unsigned int>(game));
+
+				if (!journalPrefix.empty())
+					bot.startJournal();
+
+				bot.play(maxTurns);
+
+				if (!journalPrefix.empty())
+					bot.saveJournal(journalPrefix + std::to_string(game) + ".journal");
+
+				++local.numGames;
+				local.numTurns += bot.getNumTurns();
+				++local.depths[bot.getMaxDepth()];
+				++local.endings[bot.isDead() ? std::string(bot.getDeathCause()) : "turn limit"];
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			results.add(local);
+		};
+
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+
+		for (std::size_t i = 0; i < numThreads; ++i)
+			threads.emplace_back(work);
+
+		for (auto& thread : threads)
+			thread.join();
+
+		results.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return results;
+	}
+
+	std::size_t getArgument(int argc, char* argv[], int i, std::size_t defaultValue)
+	{
+		return i < argc ? std::strtoul(argv[i], nullptr, 10) : defaultValue;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t numCores = std::max(std::thread::hardware_concurrency(), 1u);
+	const std::size_t numGames = getArgument(argc, argv, 1, 1000);
+	const std::size_t numThreads = getArgument(argc, argv, 2, numCores);
+	const std::size_t maxTurns = getArgument(argc, argv, 3, 20000);
+	const std::string journalPrefix = argc > 4 ? argv[4] : "";
+
+	std::cout << std::fixed << std::setprecision(1);
+
+	Results results;
+
+	if (numThreads == 0)
+	{
+		const Results single = play(numGames, 1, maxTurns, journalPrefix);
+
+		for (std::size_t threads = 1; threads <= numCores; threads *= 2)
+		{
+			results = threads == 1 ? single : play(numGames, threads, maxTurns, journalPrefix);
+
+			const bool same = results.numTurns == single.numTurns && results.depths == single.depths && results.endings == single.endings;
+
+			std::cout << std::setw(3) << threads << " threads: " << results.numTurns / results.seconds << " turns/s, "
+				<< std::setprecision(2) << single.seconds / results.seconds << "x" << std::setprecision(1)
+				<< (same ? "" : ", different results!") << '\n';
+		}
+	}
+
+	else
+		results = play(numGames, numThreads, maxTurns, journalPrefix);
+
+	std::cout << results.numGames << " games, " << results.numTurns << " turns in " << results.seconds << " s\n";
+	std::cout << "  " << results.numGames / results.seconds << " games/s, " << results.numTurns / results.seconds << " turns/s\n";
+
+	std::cout << "Depth reached\n";
+	for (const auto& [depth, count] : results.depths)
+		std::cout << "  " << std::setw(3) << depth << ": " << count << " (" << 100.0 * count / results.numGames << "%)\n";
+
+	std::cout << "Endings\n";
+	for (const auto& [ending, count] : results.endings)
+		std::cout << "  " << ending << ": " << count << " (" << 100.0 * count / results.numGames << "%)\n";
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+// Plays a journal written with --journal again as fast as possible, without drawing,
+// and times every turn to find the slow ones.
+// Usage: Replay journal [number of slowest turns to list]
+
+#include "World.hpp"
+
+#include <algorithm> // sort, partial_sort, min
+#include <chrono>
+#include <cstdlib> // strtoul
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric> // accumulate, iota
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	// Keeps the level up menu the replayed actions open, the journal closes it
+	class Host : public MenuHost
+	{
+	public:
+		void openMenu(std::unique_ptr<Menu> menu) override
+		{
+			m_menu = std::move(menu);
+		}
+
+		void closeMenu() override
+		{
+			m_menu = nullptr;
+		}
+
+	private:
+		std::unique_ptr<Menu> m_menu = nullptr;
+	};
+
+	std::string_view getName(Journal::Action action)
+	{
+		switch (action)
+		{
+		case Journal::Action::Move:    return "move";
+		case Journal::Action::Wait:    return "wait";
+		case Journal::Action::Use:     return "use";
+		case Journal::Action::Drop:    return "drop";
+		case Journal::Action::Throw:   return "throw";
+		case Journal::Action::LevelUp: return "level up";
+		}
+
+		return "?";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: Replay journal [number of slowest turns to list]\n";
+		return 1;
+	}
+
+	const std::size_t numSlowest = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+
+	std::ifstream ifs(argv[1], std::ios::binary);
+
+	if (!ifs)
+	{
+		std::cout << "Error: Unable to open " << argv[1] << ".\n";
+		return 1;
+	}
+
+	Journal journal;
+	journal.load(ifs);
+
+	if (!ifs)
+	{
+		std::cout << "Error: " << argv[1] << " is not a journal.\n";
+		return 1;
+	}
+
+	const auto& entries = journal.getEntries();
+
+	Host host;
+	World world(host, journal.getScreenWidth(), journal.getScreenHeight(), journal.getSeed(), 1);
+	world.createLevel();
+	world.update(); // The first frame
+
+	std::vector<double> times; // Microseconds per turn
+	times.reserve(entries.size());
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (const auto& entry : entries)
+	{
+		if (world.getGameState() != GameState::PlayerTurn)
+			break;
+
+		const auto turnStart = std::chrono::steady_clock::now();
+
+		world.replay(entry);
+		world.update();
+
+		times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - turnStart).count());
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const bool same = times.size() == entries.size() && world.getChecksum() == journal.getChecksum();
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "Seed " << journal.getSeed() << ", " << times.size() << " of " << entries.size() << " turns in " << seconds * 1000.0 << " ms, "
+		<< times.size() / seconds << " turns/s\n";
+	std::cout << (same ? "Same game as recorded\n" : "Diverged from the recorded game\n");
+
+	if (times.empty())
+		return same ? 0 : 1;
+
+	std::vector<double> sorted = times;
+	std::sort(sorted.begin(), sorted.end());
+
+	const auto percentile = [&] (double p) { return sorted[static_cast<std::size_t>(p * (sorted.size() - 1))]; };
+
+	std::cout << "Turn times (us): mean " << std::accumulate(times.begin(), times.end(), 0.0) / times.size()
+		<< ", median " << percentile(0.5) << ", 99th percentile " << percentile(0.99) << ", max " << sorted.back() << '\n';
+
+	// By turn number, to bisect against another build replaying the same journal
+	std::vector<std::size_t> slowest(times.size());
+	std::iota(slowest.begin(), slowest.end(), 0);
+
+	const std::size_t count = std::min(numSlowest, slowest.size());
+	std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(),
+		[&] (std::size_t a, std::size_t b) { return times[a] > times[b]; });
+
+	std::cout << "Slowest turns\n";
+	for (std::size_t i = 0; i < count; ++i)
+		std::cout << "  " << std::setw(6) << slowest[i] << ' ' << std::setw(8) << getName(entries[slowest[i]].action) << ' ' << times[slowest[i]] << " us\n";
+
+	return same ? 0 : 1;
+}